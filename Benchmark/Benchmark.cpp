@@ -0,0 +1,760 @@
+// Benchmark of PitchAnalyzer::Analyze over a grid of buffer sizes, filter sizes, sample types and detectors, and of
+// streaming convolution by DSP::OverlapSaveFilter against direct form and of streaming analysis by the sliding DFT.
+// Results are written as JSON to the file given as the first argument, or to the standard output.
+
+#define PROFILE_ANALYSIS_STAGES
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "OverlapSaveFilter.h"
+#include "PitchAnalyzer.h"
+#include "SignalGenerator.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace winrt::Tuner::implementation;
+
+namespace
+{
+	std::atomic<uint64_t> s_allocationCount{ 0U };
+
+	void* Allocate(size_t size)
+	{
+		s_allocationCount.fetch_add(1U, std::memory_order_relaxed);
+
+		if (void* ptr = std::malloc(size ? size : 1U))
+		{
+			return ptr;
+		}
+
+		throw std::bad_alloc();
+	}
+
+	void* AllocateAligned(size_t size, std::align_val_t alignment)
+	{
+		s_allocationCount.fetch_add(1U, std::memory_order_relaxed);
+
+		const size_t align = static_cast<size_t>(alignment);
+		// aligned_alloc requires size to be a multiple of the alignment
+		const size_t alignedSize = (size + align - 1U) / align * align;
+
+#ifdef _WIN32
+		void* ptr = _aligned_malloc(alignedSize ? alignedSize : align, align);
+#else
+		void* ptr = std::aligned_alloc(align, alignedSize ? alignedSize : align);
+#endif
+
+		if (ptr)
+		{
+			return ptr;
+		}
+
+		throw std::bad_alloc();
+	}
+
+	void DeallocateAligned(void* ptr) noexcept
+	{
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+// Count every heap allocation made by the process
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { DeallocateAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { DeallocateAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { DeallocateAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { DeallocateAligned(ptr); }
+
+namespace
+{
+	constexpr uint32_t	s_samplingFrequency{ 44100U };
+	constexpr float		s_minFrequency{ 80.0f };
+	constexpr float		s_maxFrequency{ 1200.0f };
+	constexpr float		s_baseToneFrequency{ 440.0f };
+	// Fundamental of the test signal, slightly detuned A2 so it does not fall on a bin center
+	constexpr double	s_testFrequency{ 110.37 };
+	// Consecutive windows overlap by 7/8 of their length
+	constexpr size_t	s_hopDivisor{ 8U };
+	// Number of consecutive windows in the test signal, the analysis cycles through them
+	constexpr size_t	s_signalHopCount{ 16U };
+
+	// Each configuration runs for at least that long, but no less than s_minIterations times
+	constexpr std::chrono::milliseconds s_minDuration{ 500 };
+	constexpr size_t	s_minIterations{ 20U };
+	constexpr size_t	s_warmUpIterations{ 3U };
+
+	constexpr std::array<size_t, 7> s_bufferSizes{ 2048U, 4096U, 8192U, 16384U, 32768U, 65536U, 131072U };
+	constexpr std::array<size_t, 6> s_filterSizes{ 256U, 512U, 1024U, 2048U, 4096U, 8192U };
+
+	// Decimated Harmonic Product Spectrum runs buffers from 8192 samples on, with a filter as long in time
+	// as the full rate one of s_decimatedReferenceFilterSize taps, so both have the same frequency resolution
+	constexpr std::array<size_t, 2> s_decimationFactors{ 8U, 16U };
+	constexpr size_t	s_decimatedFirstBufferSize{ 2U };
+	constexpr size_t	s_decimatedReferenceFilterSize{ 4096U };
+
+	// Zoom refinement runs every buffer size with that filter size
+	constexpr size_t	s_zoomedFilterSize{ 1024U };
+
+	// Streaming convolution of a signal of s_convolutionSignalLength samples, a multiple of every block size,
+	// by overlap-save and in direct form. Direct form is slow on long filters, so fewer iterations are required.
+	constexpr std::array<size_t, 4> s_convolutionFilterSizes{ 64U, 512U, 4096U, 16384U };
+	constexpr std::array<size_t, 3> s_convolutionBlockSizes{ 64U, 256U, 1024U };
+	constexpr size_t	s_convolutionSignalLength{ 1U << 15 };
+	constexpr size_t	s_convolutionMinIterations{ 3U };
+
+	// Streaming analysis by the sliding DFT against an FFT of the window every hop, for buffer sizes of s_bufferSizes
+	// up to s_slidingBufferSizeCount with that filter size. Each configuration streams s_slidingHopCount hops.
+	constexpr size_t	s_slidingBufferSizeCount{ 3U };
+	constexpr size_t	s_slidingFilterSize{ 1024U };
+	constexpr std::array<size_t, 3> s_slidingHopSizes{ 16U, 64U, 256U };
+	constexpr size_t	s_slidingHopCount{ 64U };
+
+	struct BenchmarkResult
+	{
+		std::string	detector;
+		std::string	sampleType;
+		size_t		bufferSize;
+		size_t		filterSize;
+		size_t		decimationFactor;
+		bool		zoomRefinement;
+		size_t		fftSize;
+		// Length of the filtered signal the FFT would have without padding to a fast size
+		size_t		unpaddedFFTSize;
+		size_t		iterations;
+		double		decimationNs;
+		double		windowNs;
+		double		fftNs;
+		double		filterNs;
+		double		detectionNs;
+		double		zoomNs;
+		double		noteLookupNs;
+		// Standalone real FFT of the padded and of the unpadded length
+		double		paddedFFTNs;
+		double		unpaddedFFTNs;
+		double		frameNs;
+		double		framesPerSecond;
+		double		allocationsPerFrame;
+		size_t		hopSize;
+		double		latencyMs;
+		double		realTimeLoad;
+		float		detectedFrequency;
+		double		centsError;
+	};
+
+	struct ConvolutionResult
+	{
+		std::string	sampleType;
+		size_t		filterSize;
+		size_t		blockSize;
+		size_t		partitionCount;
+		double		overlapSaveNsPerSample;
+		double		directNsPerSample;
+		// Largest difference between the outputs relative to the largest output sample
+		double		relativeError;
+	};
+
+	struct SlidingResult
+	{
+		std::string	sampleType;
+		size_t		bufferSize;
+		size_t		filterSize;
+		size_t		hopSize;
+		size_t		fftSize;
+		// Mean time from one frame to the next, streaming through the sliding DFT and analyzing every window by FFT
+		double		slidingFrameNs;
+		double		fftFrameNs;
+		double		slidingDFTNs;
+		// Largest difference between the frequencies of the same frames
+		double		maxDifferenceCents;
+		double		centsError;
+	};
+
+	template<typename sample_t>
+	constexpr const char* SampleTypeName() noexcept
+	{
+		if constexpr (std::is_same_v<sample_t, float>)
+		{
+			return "float";
+		}
+		else
+		{
+			return "double";
+		}
+	}
+
+	// Mean time of a real FFT of the given length, measured outside the analyzer so that
+	// the padded and the unpadded length are compared under the same conditions
+	template<typename sample_t>
+	double MeasureFFT(size_t fftSize)
+	{
+		using clock_t = std::chrono::steady_clock;
+
+		std::vector<sample_t> input(fftSize);
+		std::vector<std::complex<sample_t>> output(fftSize / 2U + 1U);
+		DSP::FFTPlan<sample_t> fftPlan(input.begin(), input.end(), output.begin());
+
+		// Planning overwrites the arrays
+		auto generator = std::make_unique<SignalGenerator>(s_samplingFrequency, input.size());
+		generator->AddHarmonics(s_testFrequency, 6U, 0.5, 0.6);
+		generator->Generate(input.begin(), input.end());
+
+		for (size_t i = 0U; i < s_warmUpIterations; i++)
+		{
+			fftPlan.Execute();
+		}
+
+		size_t iterations = 0U;
+		const auto start = clock_t::now();
+		auto elapsed = clock_t::duration::zero();
+
+		while (iterations < s_minIterations || elapsed < s_minDuration)
+		{
+			fftPlan.Execute();
+			elapsed = clock_t::now() - start;
+			iterations++;
+		}
+
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / static_cast<double>(iterations);
+	}
+
+	template<typename sample_t, size_t s_bufferSize, size_t s_filterSize, template<typename, size_t, size_t> class Detector, size_t s_decimationFactor = 1U>
+	BenchmarkResult RunBenchmark(const char* detectorName, bool zoomRefinement = false)
+	{
+		using clock_t			= std::chrono::steady_clock;
+		using PitchAnalyzer_t	= PitchAnalyzer<s_bufferSize, s_filterSize, sample_t, Detector, s_decimationFactor>;
+
+		constexpr size_t hopSize = s_bufferSize / s_hopDivisor;
+
+		// Analyzer is too large for the stack
+		auto analyzer = std::make_unique<PitchAnalyzer_t>(s_minFrequency, s_maxFrequency, s_baseToneFrequency, static_cast<float>(s_samplingFrequency));
+
+		float detectedFrequency = 0.0f;
+		analyzer->SoundAnalyzed([&detectedFrequency](PitchAnalysisResult result) {
+			detectedFrequency = result.frequency;
+		});
+		// Zoom transform is planned by Initialize() when enabled before
+		analyzer->SetZoomRefinement(zoomRefinement);
+		analyzer->Initialize();
+		analyzer->SetHopSize(hopSize);
+
+		// Guitar-like test signal long enough for s_signalHopCount consecutive windows
+		std::vector<sample_t> input(s_bufferSize + (s_signalHopCount - 1U) * hopSize);
+		auto generator = std::make_unique<SignalGenerator>(s_samplingFrequency, input.size());
+		generator->AddHarmonics(s_testFrequency, 6U, 0.5, 0.6);
+		generator->AddNoise(0.01, 1U);
+		generator->Generate(input.begin(), input.end());
+
+		auto AnalyzeWindow = [&analyzer, &input](size_t window) {
+			const sample_t* first = input.data() + (window % s_signalHopCount) * hopSize;
+			analyzer->Analyze(first, first + s_bufferSize);
+		};
+
+		for (size_t i = 0U; i < s_warmUpIterations; i++)
+		{
+			AnalyzeWindow(i);
+		}
+
+		BenchmarkResult result{};
+		const uint64_t allocationsBefore = s_allocationCount.load();
+		const auto start = clock_t::now();
+		auto elapsed = clock_t::duration::zero();
+
+		while (result.iterations < s_minIterations || elapsed < s_minDuration)
+		{
+			AnalyzeWindow(result.iterations);
+			elapsed = clock_t::now() - start;
+
+			const auto& timings = analyzer->GetStageTimings();
+			result.decimationNs					+= static_cast<double>(timings.decimation.count());
+			result.windowNs						+= static_cast<double>(timings.window.count());
+			result.fftNs						+= static_cast<double>(timings.fft.count());
+			result.filterNs						+= static_cast<double>(timings.filter.count());
+			result.detectionNs					+= static_cast<double>(timings.detection.count());
+			result.zoomNs						+= static_cast<double>(timings.zoom.count());
+			result.noteLookupNs					+= static_cast<double>(timings.noteLookup.count());
+			result.iterations++;
+		}
+
+		const uint64_t allocations	= s_allocationCount.load() - allocationsBefore;
+		const double iterations		= static_cast<double>(result.iterations);
+
+		// Accuracy of the estimate from two consecutive windows
+		analyzer->ResetPhaseVocoder();
+		detectedFrequency = 0.0f;
+		AnalyzeWindow(0U);
+		AnalyzeWindow(1U);
+
+		result.detector						= detectorName;
+		result.sampleType					= SampleTypeName<sample_t>();
+		result.bufferSize					= s_bufferSize;
+		result.filterSize					= s_filterSize;
+		result.decimationFactor				= s_decimationFactor;
+		result.zoomRefinement				= zoomRefinement;
+		result.fftSize						= PitchAnalyzer_t::s_fftSize;
+		result.unpaddedFFTSize				= PitchAnalyzer_t::s_filteredSignalSize;
+		result.decimationNs					/= iterations;
+		result.windowNs						/= iterations;
+		result.fftNs						/= iterations;
+		result.filterNs						/= iterations;
+		result.detectionNs					/= iterations;
+		result.zoomNs						/= iterations;
+		result.noteLookupNs					/= iterations;
+		result.frameNs						= static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+		result.framesPerSecond				= 1.0e9 / result.frameNs;
+		result.allocationsPerFrame			= static_cast<double>(allocations) / iterations;
+		result.hopSize						= hopSize;
+		// Time from the oldest sample the detector uses to the result, window size is given after decimation
+		result.latencyMs					= 1.0e3 * static_cast<double>(analyzer->GetDetector().GetWindowSize() * s_decimationFactor) / s_samplingFrequency + result.frameNs * 1.0e-6;
+		// Fraction of the time between two windows spent on the analysis
+		result.realTimeLoad					= result.frameNs * 1.0e-9 * s_samplingFrequency / static_cast<double>(hopSize);
+		result.detectedFrequency			= detectedFrequency;
+		result.centsError					= detectedFrequency > 0.0f ? 1200.0 * std::log2(detectedFrequency / s_testFrequency) : 0.0;
+
+		// McLeod Pitch Method does not compute the spectrum of the filtered signal
+		if constexpr (PitchAnalyzer_t::Detector_t::s_usesSpectrum)
+		{
+			result.paddedFFTNs				= MeasureFFT<sample_t>(result.fftSize);
+			result.unpaddedFFTNs			= MeasureFFT<sample_t>(result.unpaddedFFTSize);
+		}
+
+		return result;
+	}
+
+	// Run every combination of s_bufferSizes and s_filterSizes with the Harmonic Product Spectrum
+	template<typename sample_t, size_t... I>
+	void RunGrid(std::vector<BenchmarkResult>& results, std::index_sequence<I...>)
+	{
+		constexpr size_t filterSizeCount = s_filterSizes.size();
+
+		(results.push_back(RunBenchmark<sample_t, s_bufferSizes[I / filterSizeCount], s_filterSizes[I % filterSizeCount], HarmonicProductSpectrumDetector>("harmonicProductSpectrum")), ...);
+	}
+
+	// Run every buffer size with the McLeod Pitch Method, which does not use the filter
+	template<typename sample_t, size_t... I>
+	void RunMcLeodPitchMethod(std::vector<BenchmarkResult>& results, std::index_sequence<I...>)
+	{
+		(results.push_back(RunBenchmark<sample_t, s_bufferSizes[I], s_filterSizes[0], McLeodPitchMethodDetector>("mcleodPitchMethod")), ...);
+	}
+
+	// Run every buffer size with the Goertzel bank around the notes of a guitar, which does not use the filter either
+	template<typename sample_t, size_t... I>
+	void RunTargetNote(std::vector<BenchmarkResult>& results, std::index_sequence<I...>)
+	{
+		(results.push_back(RunBenchmark<sample_t, s_bufferSizes[I], s_filterSizes[0], TargetNoteDetector>("targetNote")), ...);
+	}
+
+	// Run the Harmonic Product Spectrum on decimated buffers of s_bufferSizes from s_decimatedFirstBufferSize on
+	template<typename sample_t, size_t... I>
+	void RunDecimated(std::vector<BenchmarkResult>& results, std::index_sequence<I...>)
+	{
+		constexpr size_t factorCount = s_decimationFactors.size();
+
+		(results.push_back(RunBenchmark<
+			sample_t,
+			s_bufferSizes[s_decimatedFirstBufferSize + I / factorCount],
+			s_decimatedReferenceFilterSize / s_decimationFactors[I % factorCount],
+			HarmonicProductSpectrumDetector,
+			s_decimationFactors[I % factorCount]>("harmonicProductSpectrum")), ...);
+	}
+
+	// Direct-form FIR filter of a stream processed in blocks, the reference for DSP::OverlapSaveFilter
+	template<typename sample_t>
+	class DirectFormFilter
+	{
+		// Coefficients in reversed order, so that each tap scales a contiguous slice of the history
+		std::vector<sample_t>	m_coefficients;
+		// Last filterSize - 1 samples of the stream followed by the current block
+		std::vector<sample_t>	m_history;
+		size_t					m_blockSize;
+
+	public:
+
+		DirectFormFilter(const std::vector<sample_t>& impulseResponse, size_t blockSize) :
+			m_coefficients	( impulseResponse.rbegin(), impulseResponse.rend() ),
+			m_history		( impulseResponse.size() - 1U + blockSize, static_cast<sample_t>(0) ),
+			m_blockSize		{ blockSize }
+		{
+		}
+
+		void Process(const sample_t* first, sample_t* dest) noexcept
+		{
+			const size_t historySize = m_coefficients.size() - 1U;
+			std::copy(first, first + m_blockSize, m_history.begin() + historySize);
+			std::fill(dest, dest + m_blockSize, static_cast<sample_t>(0));
+
+			for (size_t tap = 0U; tap < m_coefficients.size(); tap++)
+			{
+				const sample_t coefficient	= m_coefficients[tap];
+				const sample_t* input		= m_history.data() + tap;
+
+				for (size_t n = 0U; n < m_blockSize; n++)
+				{
+					dest[n] += coefficient * input[n];
+				}
+			}
+
+			std::copy(m_history.end() - historySize, m_history.end(), m_history.begin());
+		}
+	};
+
+	// Mean time per sample of filtering the whole input block by block, filter(first, dest) processes one block
+	template<typename sample_t, typename _Fn>
+	double MeasureStreamFilter(const std::vector<sample_t>& input, std::vector<sample_t>& output, size_t blockSize, _Fn filter)
+	{
+		using clock_t = std::chrono::steady_clock;
+
+		auto FilterSignal = [&]() {
+			for (size_t block = 0U; block < input.size(); block += blockSize)
+			{
+				filter(input.data() + block, output.data() + block);
+			}
+		};
+
+		size_t iterations = 0U;
+		const auto start = clock_t::now();
+		auto elapsed = clock_t::duration::zero();
+
+		while (iterations < s_convolutionMinIterations || elapsed < s_minDuration)
+		{
+			FilterSignal();
+			elapsed = clock_t::now() - start;
+			iterations++;
+		}
+
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / static_cast<double>(iterations * input.size());
+	}
+
+	// Filter the test signal with the band-pass filter of the analyzer by overlap-save and in direct form
+	template<typename sample_t>
+	ConvolutionResult RunConvolution(size_t filterSize, size_t blockSize)
+	{
+		std::vector<sample_t> impulseResponse(filterSize);
+		DSP::GenerateBandPassFIR(s_minFrequency, s_maxFrequency, s_samplingFrequency, impulseResponse.begin(), impulseResponse.end());
+
+		std::vector<sample_t> input(s_convolutionSignalLength);
+		auto generator = std::make_unique<SignalGenerator>(s_samplingFrequency, input.size());
+		generator->AddHarmonics(s_testFrequency, 6U, 0.5, 0.6);
+		generator->AddNoise(0.01, 1U);
+		generator->Generate(input.begin(), input.end());
+
+		DSP::OverlapSaveFilter<sample_t> overlapSaveFilter(impulseResponse.begin(), impulseResponse.end(), blockSize);
+		DirectFormFilter<sample_t> directFormFilter(impulseResponse, blockSize);
+
+		std::vector<sample_t> overlapSaveOutput(input.size());
+		std::vector<sample_t> directOutput(input.size());
+
+		// Both filters start from silence, their outputs are compared before timing
+		for (size_t block = 0U; block < input.size(); block += blockSize)
+		{
+			overlapSaveFilter.Process(input.data() + block, input.data() + block + blockSize, overlapSaveOutput.data() + block);
+			directFormFilter.Process(input.data() + block, directOutput.data() + block);
+		}
+
+		double maxDifference	= 0.0;
+		double maxOutput		= 0.0;
+
+		for (size_t n = 0U; n < input.size(); n++)
+		{
+			maxDifference	= std::max(maxDifference, static_cast<double>(std::abs(overlapSaveOutput[n] - directOutput[n])));
+			maxOutput		= std::max(maxOutput, static_cast<double>(std::abs(directOutput[n])));
+		}
+
+		ConvolutionResult result{};
+		result.overlapSaveNsPerSample = MeasureStreamFilter(input, overlapSaveOutput, blockSize, [&overlapSaveFilter, blockSize](const sample_t* first, sample_t* dest) {
+			overlapSaveFilter.Process(first, first + blockSize, dest);
+		});
+		result.directNsPerSample = MeasureStreamFilter(input, directOutput, blockSize, [&directFormFilter](const sample_t* first, sample_t* dest) {
+			directFormFilter.Process(first, dest);
+		});
+
+		result.sampleType		= SampleTypeName<sample_t>();
+		result.filterSize		= filterSize;
+		result.blockSize		= blockSize;
+		result.partitionCount	= overlapSaveFilter.GetPartitionCount();
+		result.relativeError	= maxOutput > 0.0 ? maxDifference / maxOutput : maxDifference;
+
+		return result;
+	}
+
+	// Run every combination of s_convolutionFilterSizes and s_convolutionBlockSizes
+	template<typename sample_t>
+	void RunConvolutionGrid(std::vector<ConvolutionResult>& results)
+	{
+		for (const size_t filterSize : s_convolutionFilterSizes)
+		{
+			for (const size_t blockSize : s_convolutionBlockSizes)
+			{
+				results.push_back(RunConvolution<sample_t>(filterSize, blockSize));
+			}
+		}
+	}
+
+	// Run the Harmonic Product Spectrum refined by the chirp-z transform on the zoomed spectrum, for every buffer size
+	template<typename sample_t, size_t... I>
+	void RunZoomed(std::vector<BenchmarkResult>& results, std::index_sequence<I...>)
+	{
+		(results.push_back(RunBenchmark<sample_t, s_bufferSizes[I], s_zoomedFilterSize, HarmonicProductSpectrumDetector>("harmonicProductSpectrum", true)), ...);
+	}
+
+	// Analyze the same stream by AnalyzeStream() and by Analyze() on each window, both every hopSize samples
+	template<typename sample_t, size_t s_bufferSize>
+	SlidingResult RunSliding(size_t hopSize)
+	{
+		using clock_t			= std::chrono::steady_clock;
+		using PitchAnalyzer_t	= PitchAnalyzer<s_bufferSize, s_slidingFilterSize, sample_t, HarmonicProductSpectrumDetector>;
+
+		std::vector<sample_t> input(s_bufferSize + s_slidingHopCount * hopSize);
+		auto generator = std::make_unique<SignalGenerator>(s_samplingFrequency, input.size());
+		generator->AddHarmonics(s_testFrequency, 6U, 0.5, 0.6);
+		generator->AddNoise(0.01, 1U);
+		generator->Generate(input.begin(), input.end());
+
+		std::vector<float> slidingFrequencies;
+		std::vector<float> fftFrequencies;
+		slidingFrequencies.reserve(s_slidingHopCount + 1U);
+		fftFrequencies.reserve(s_slidingHopCount + 1U);
+
+		auto slidingAnalyzer	= std::make_unique<PitchAnalyzer_t>(s_minFrequency, s_maxFrequency, s_baseToneFrequency, static_cast<float>(s_samplingFrequency));
+		auto fftAnalyzer		= std::make_unique<PitchAnalyzer_t>(s_minFrequency, s_maxFrequency, s_baseToneFrequency, static_cast<float>(s_samplingFrequency));
+
+		slidingAnalyzer->SoundAnalyzed([&slidingFrequencies](PitchAnalysisResult result) {
+			slidingFrequencies.push_back(result.frequency);
+		});
+		fftAnalyzer->SoundAnalyzed([&fftFrequencies](PitchAnalysisResult result) {
+			fftFrequencies.push_back(result.frequency);
+		});
+
+		slidingAnalyzer->Initialize();
+		fftAnalyzer->Initialize();
+		slidingAnalyzer->SetHopSize(hopSize);
+		fftAnalyzer->SetHopSize(hopSize);
+
+		SlidingResult result{};
+
+		// Frame of the first window, which fills the sliding DFT, is not timed. Stream is passed hop by hop,
+		// as an audio device would deliver it.
+		slidingAnalyzer->AnalyzeStream(input.data(), input.data() + s_bufferSize);
+		fftAnalyzer->Analyze(input.data(), input.data() + s_bufferSize);
+
+		auto start = clock_t::now();
+
+		for (size_t offset = s_bufferSize; offset < input.size(); offset += hopSize)
+		{
+			slidingAnalyzer->AnalyzeStream(input.data() + offset, input.data() + offset + hopSize);
+			result.slidingDFTNs += static_cast<double>(slidingAnalyzer->GetStageTimings().slidingDFT.count());
+		}
+
+		result.slidingFrameNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count());
+
+		start = clock_t::now();
+
+		for (size_t offset = hopSize; offset + s_bufferSize <= input.size(); offset += hopSize)
+		{
+			fftAnalyzer->Analyze(input.data() + offset, input.data() + offset + s_bufferSize);
+		}
+
+		result.fftFrameNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count());
+
+		const double frames = static_cast<double>(s_slidingHopCount);
+
+		for (size_t frame = 0U; frame < std::min(slidingFrequencies.size(), fftFrequencies.size()); frame++)
+		{
+			if (slidingFrequencies[frame] > 0.0f && fftFrequencies[frame] > 0.0f)
+			{
+				result.maxDifferenceCents = std::max(result.maxDifferenceCents, std::abs(1200.0 * std::log2(static_cast<double>(slidingFrequencies[frame]) / fftFrequencies[frame])));
+			}
+		}
+
+		result.sampleType		= SampleTypeName<sample_t>();
+		result.bufferSize		= s_bufferSize;
+		result.filterSize		= s_slidingFilterSize;
+		result.hopSize			= hopSize;
+		result.fftSize			= PitchAnalyzer_t::s_fftSize;
+		result.slidingFrameNs	/= frames;
+		result.fftFrameNs		/= frames;
+		result.slidingDFTNs		/= frames;
+		result.centsError		= !slidingFrequencies.empty() && slidingFrequencies.back() > 0.0f ? 1200.0 * std::log2(slidingFrequencies.back() / s_testFrequency) : 0.0;
+
+		return result;
+	}
+
+	// Run every hop of s_slidingHopSizes for the first s_slidingBufferSizeCount buffer sizes
+	template<typename sample_t, size_t... I>
+	void RunSlidingGrid(std::vector<SlidingResult>& results, std::index_sequence<I...>)
+	{
+		for (const size_t hopSize : s_slidingHopSizes)
+		{
+			(results.push_back(RunSliding<sample_t, s_bufferSizes[I]>(hopSize)), ...);
+		}
+	}
+
+	void WriteJSON(std::ostream& out, const std::vector<BenchmarkResult>& results, const std::vector<ConvolutionResult>& convolutionResults, const std::vector<SlidingResult>& slidingResults)
+	{
+		out << "{\n";
+		out << "  \"benchmark\": \"PitchAnalyzer::Analyze\",\n";
+		out << "  \"samplingFrequency\": " << s_samplingFrequency << ",\n";
+		out << "  \"testFrequency\": " << s_testFrequency << ",\n";
+		out << "  \"results\": [\n";
+
+		for (size_t i = 0U; i < results.size(); i++)
+		{
+			const BenchmarkResult& result = results[i];
+
+			out << "    {\n";
+			out << "      \"detector\": \"" << result.detector << "\",\n";
+			out << "      \"sampleType\": \"" << result.sampleType << "\",\n";
+			out << "      \"bufferSize\": " << result.bufferSize << ",\n";
+			out << "      \"filterSize\": " << result.filterSize << ",\n";
+			out << "      \"decimationFactor\": " << result.decimationFactor << ",\n";
+			out << "      \"zoomRefinement\": " << (result.zoomRefinement ? "true" : "false") << ",\n";
+			out << "      \"fftSize\": " << result.fftSize << ",\n";
+			out << "      \"unpaddedFFTSize\": " << result.unpaddedFFTSize << ",\n";
+			out << "      \"iterations\": " << result.iterations << ",\n";
+			out << "      \"stageNs\": {\n";
+			out << "        \"decimation\": " << result.decimationNs << ",\n";
+			out << "        \"window\": " << result.windowNs << ",\n";
+			out << "        \"fft\": " << result.fftNs << ",\n";
+			out << "        \"filter\": " << result.filterNs << ",\n";
+			out << "        \"detection\": " << result.detectionNs << ",\n";
+			out << "        \"zoom\": " << result.zoomNs << ",\n";
+			out << "        \"noteLookup\": " << result.noteLookupNs << "\n";
+			out << "      },\n";
+			out << "      \"fftComparisonNs\": {\n";
+			out << "        \"padded\": " << result.paddedFFTNs << ",\n";
+			out << "        \"unpadded\": " << result.unpaddedFFTNs << "\n";
+			out << "      },\n";
+			out << "      \"frameNs\": " << result.frameNs << ",\n";
+			out << "      \"framesPerSecond\": " << result.framesPerSecond << ",\n";
+			out << "      \"allocationsPerFrame\": " << result.allocationsPerFrame << ",\n";
+			out << "      \"hopSize\": " << result.hopSize << ",\n";
+			out << "      \"latencyMs\": " << result.latencyMs << ",\n";
+			out << "      \"realTimeLoad\": " << result.realTimeLoad << ",\n";
+			out << "      \"detectedFrequency\": " << result.detectedFrequency << ",\n";
+			out << "      \"centsError\": " << result.centsError << "\n";
+			out << "    }" << (i + 1U < results.size() ? "," : "") << "\n";
+		}
+
+		out << "  ],\n";
+		out << "  \"convolution\": [\n";
+
+		for (size_t i = 0U; i < convolutionResults.size(); i++)
+		{
+			const ConvolutionResult& result = convolutionResults[i];
+
+			out << "    {\n";
+			out << "      \"sampleType\": \"" << result.sampleType << "\",\n";
+			out << "      \"filterSize\": " << result.filterSize << ",\n";
+			out << "      \"blockSize\": " << result.blockSize << ",\n";
+			out << "      \"partitionCount\": " << result.partitionCount << ",\n";
+			out << "      \"nsPerSample\": {\n";
+			out << "        \"overlapSave\": " << result.overlapSaveNsPerSample << ",\n";
+			out << "        \"direct\": " << result.directNsPerSample << "\n";
+			out << "      },\n";
+			out << "      \"relativeError\": " << result.relativeError << "\n";
+			out << "    }" << (i + 1U < convolutionResults.size() ? "," : "") << "\n";
+		}
+
+		out << "  ],\n";
+		out << "  \"sliding\": [\n";
+
+		for (size_t i = 0U; i < slidingResults.size(); i++)
+		{
+			const SlidingResult& result = slidingResults[i];
+
+			out << "    {\n";
+			out << "      \"sampleType\": \"" << result.sampleType << "\",\n";
+			out << "      \"bufferSize\": " << result.bufferSize << ",\n";
+			out << "      \"filterSize\": " << result.filterSize << ",\n";
+			out << "      \"hopSize\": " << result.hopSize << ",\n";
+			out << "      \"fftSize\": " << result.fftSize << ",\n";
+			out << "      \"frameNs\": {\n";
+			out << "        \"slidingDFT\": " << result.slidingFrameNs << ",\n";
+			out << "        \"fft\": " << result.fftFrameNs << "\n";
+			out << "      },\n";
+			out << "      \"slidingDFTStageNs\": " << result.slidingDFTNs << ",\n";
+			out << "      \"maxDifferenceCents\": " << result.maxDifferenceCents << ",\n";
+			out << "      \"centsError\": " << result.centsError << "\n";
+			out << "    }" << (i + 1U < slidingResults.size() ? "," : "") << "\n";
+		}
+
+		out << "  ]\n";
+		out << "}\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	constexpr size_t gridSize		= s_bufferSizes.size() * s_filterSizes.size();
+	constexpr size_t decimatedSize	= (s_bufferSizes.size() - s_decimatedFirstBufferSize) * s_decimationFactors.size();
+
+	std::vector<BenchmarkResult> results;
+	results.reserve(2U * (gridSize + decimatedSize + 3U * s_bufferSizes.size()));
+
+	RunGrid<float>(results, std::make_index_sequence<gridSize>{});
+	RunGrid<double>(results, std::make_index_sequence<gridSize>{});
+	RunDecimated<float>(results, std::make_index_sequence<decimatedSize>{});
+	RunDecimated<double>(results, std::make_index_sequence<decimatedSize>{});
+	RunMcLeodPitchMethod<float>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+	RunMcLeodPitchMethod<double>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+	RunTargetNote<float>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+	RunTargetNote<double>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+	RunZoomed<float>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+	RunZoomed<double>(results, std::make_index_sequence<s_bufferSizes.size()>{});
+
+	std::vector<ConvolutionResult> convolutionResults;
+	convolutionResults.reserve(2U * s_convolutionFilterSizes.size() * s_convolutionBlockSizes.size());
+
+	RunConvolutionGrid<float>(convolutionResults);
+	RunConvolutionGrid<double>(convolutionResults);
+
+	std::vector<SlidingResult> slidingResults;
+	slidingResults.reserve(2U * s_slidingBufferSizeCount * s_slidingHopSizes.size());
+
+	RunSlidingGrid<float>(slidingResults, std::make_index_sequence<s_slidingBufferSizeCount>{});
+	RunSlidingGrid<double>(slidingResults, std::make_index_sequence<s_slidingBufferSizeCount>{});
+
+	if (argc > 1)
+	{
+		std::ofstream file(argv[1]);
+
+		if (!file)
+		{
+			std::cerr << "Cannot open " << argv[1] << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		WriteJSON(file, results, convolutionResults, slidingResults);
+	}
+	else
+	{
+		WriteJSON(std::cout, results, convolutionResults, slidingResults);
+	}
+
+	return EXIT_SUCCESS;
+}
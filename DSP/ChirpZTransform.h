@@ -0,0 +1,248 @@
+#pragma once
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "DSPMath.h"
+#include "DSPTypeTraits.h"
+#include "FFTPlan.h"
+
+namespace DSP
+{
+	// Zoom FFT by the chirp-z transform (Bluestein's algorithm). Spectrum of a block of real samples is
+	// evaluated at binCount frequencies firstFrequency + k * binSpacing, spaced as finely as needed, over
+	// a band which may move between calls. The sum is rewritten as a linear convolution with a chirp and
+	// computed by two complex FFTs of at least inputSize + binCount - 1 points, so zooming into a narrow
+	// band costs about as much as a transform of the input, not of the length the spacing would require.
+	// Frequencies are given as fractions of the sampling frequency.
+	template<typename _Ty>
+	class ChirpZTransform
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		using complex_t = std::complex<_Ty>;
+		// Chirp phases grow with the square of the index, they are computed in double precision at least
+		using compute_t = std::conditional_t<Is_long_double<_Ty>, long double, double>;
+
+		// Shift of the band is applied by a phasor rotated once per sample, started from the exact
+		// phase every that many samples
+		static constexpr size_t s_phasorBlockLength{ 256U };
+
+		// exp(-i * pi * n^2 * binSpacing) of the input and of the output samples
+		std::vector<complex_t>	m_inputChirp;
+		std::vector<complex_t>	m_outputChirp;
+		// Spectrum of the conjugate chirp over indices (-inputSize, binCount), scaled by 1 / FFT size
+		std::vector<complex_t>	m_kernelSpectrum;
+		// Chirped input zero-padded to the FFT size, overwritten by the result of the convolution
+		std::vector<complex_t>	m_signal;
+		std::vector<complex_t>	m_spectrum;
+
+		FFTPlan<_Ty>			m_forwardPlan;
+		FFTPlan<_Ty>			m_inversePlan;
+
+		size_t					m_inputSize;
+		size_t					m_binCount;
+		compute_t				m_binSpacing;
+
+		// exp(i * sign * pi * n^2 * binSpacing), the phase is reduced exactly before it is scaled by pi
+		complex_t GetChirp(size_t n, compute_t sign) const noexcept;
+
+	public:
+
+		// Empty transform, has to be replaced by a constructed one before use
+		ChirpZTransform() noexcept;
+
+		// Transform of inputSize samples into binCount bins binSpacing apart. FFT plans are created with the given flags,
+		// the transform evaluates to false if flags::wisdom was passed and no wisdom was found.
+		ChirpZTransform(size_t inputSize, size_t binCount, double binSpacing, flags _flags = flags::measure);
+
+		ChirpZTransform(ChirpZTransform&&)				= default;
+		ChirpZTransform& operator=(ChirpZTransform&&)	= default;
+
+		ChirpZTransform(const ChirpZTransform&)				= delete;
+		ChirpZTransform& operator=(const ChirpZTransform&)	= delete;
+
+		// Length of the complex FFTs computing the transform of the given size
+		static constexpr size_t GetFFTSize(size_t inputSize, size_t binCount) noexcept;
+
+		// Check if FFT plans were created
+		explicit operator bool() const noexcept;
+
+		size_t GetInputSize() const noexcept;
+		size_t GetBinCount() const noexcept;
+		double GetBinSpacing() const noexcept;
+
+		// Evaluate the spectrum of [first, last), which must hold exactly GetInputSize() samples, at frequencies
+		// firstFrequency + k * GetBinSpacing(), writing GetBinCount() complex bins to dest
+		template<typename _InIt, typename _OutIt>
+		void Transform(_InIt first, _InIt last, double firstFrequency, _OutIt dest) noexcept;
+	};
+
+	template<typename _Ty>
+	inline ChirpZTransform<_Ty>::ChirpZTransform() noexcept :
+		m_inputSize		{ 0U },
+		m_binCount		{ 0U },
+		m_binSpacing	{ 0 }
+	{
+	}
+
+	template<typename _Ty>
+	inline ChirpZTransform<_Ty>::ChirpZTransform(size_t inputSize, size_t binCount, double binSpacing, flags _flags) :
+		ChirpZTransform()
+	{
+		if (inputSize == 0U || binCount == 0U)
+		{
+			throw std::invalid_argument("Input size and bin count must be positive.");
+		}
+
+		if (!(binSpacing > 0.0))
+		{
+			throw std::invalid_argument("Bin spacing must be positive.");
+		}
+
+		const size_t fftSize = GetFFTSize(inputSize, binCount);
+
+		m_inputSize		= inputSize;
+		m_binCount		= binCount;
+		m_binSpacing	= static_cast<compute_t>(binSpacing);
+
+		m_signal.resize(fftSize);
+		m_spectrum.resize(fftSize);
+
+		m_forwardPlan = FFTPlan<_Ty>(m_signal.begin(), m_signal.end(), m_spectrum.begin(), _flags, direction::forward);
+		m_inversePlan = FFTPlan<_Ty>(m_spectrum.begin(), m_spectrum.end(), m_signal.begin(), _flags, direction::backward);
+
+		if (!*this)
+		{
+			return;
+		}
+
+		m_inputChirp.resize(inputSize);
+		m_outputChirp.resize(binCount);
+
+		for (size_t n = 0U; n < inputSize; n++)
+		{
+			m_inputChirp[n] = GetChirp(n, static_cast<compute_t>(-1));
+		}
+
+		for (size_t k = 0U; k < binCount; k++)
+		{
+			m_outputChirp[k] = GetChirp(k, static_cast<compute_t>(-1));
+		}
+
+		// n * k = (n^2 + k^2 - (k - n)^2) / 2, so bin k is the convolution of the chirped input with
+		// exp(i * pi * m^2 * binSpacing) at m = k - n. Negative indices wrap around the end of the FFT.
+		const _Ty scale = static_cast<_Ty>(1) / static_cast<_Ty>(fftSize);
+		std::fill(m_signal.begin(), m_signal.end(), complex_t(0));
+
+		for (size_t m = 0U; m < binCount; m++)
+		{
+			m_signal[m] = scale * GetChirp(m, static_cast<compute_t>(1));
+		}
+
+		for (size_t m = 1U; m < inputSize; m++)
+		{
+			m_signal[fftSize - m] = scale * GetChirp(m, static_cast<compute_t>(1));
+		}
+
+		m_forwardPlan.Execute();
+		m_kernelSpectrum = m_spectrum;
+
+		std::fill(m_signal.begin(), m_signal.end(), complex_t(0));
+	}
+
+	template<typename _Ty>
+	inline constexpr size_t ChirpZTransform<_Ty>::GetFFTSize(size_t inputSize, size_t binCount) noexcept
+	{
+		return NextFastFFTSize(inputSize + binCount - 1U);
+	}
+
+	template<typename _Ty>
+	inline ChirpZTransform<_Ty>::operator bool() const noexcept
+	{
+		return m_forwardPlan && m_inversePlan;
+	}
+
+	template<typename _Ty>
+	inline size_t ChirpZTransform<_Ty>::GetInputSize() const noexcept
+	{
+		return m_inputSize;
+	}
+
+	template<typename _Ty>
+	inline size_t ChirpZTransform<_Ty>::GetBinCount() const noexcept
+	{
+		return m_binCount;
+	}
+
+	template<typename _Ty>
+	inline double ChirpZTransform<_Ty>::GetBinSpacing() const noexcept
+	{
+		return static_cast<double>(m_binSpacing);
+	}
+
+	template<typename _Ty>
+	inline typename ChirpZTransform<_Ty>::complex_t ChirpZTransform<_Ty>::GetChirp(size_t n, compute_t sign) const noexcept
+	{
+		// n^2 is exact up to 2^53, the phase is taken modulo 2 pi before it loses precision
+		const compute_t square	= static_cast<compute_t>(n) * static_cast<compute_t>(n);
+		const compute_t phase	= sign * pi<compute_t> * std::fmod(square * m_binSpacing, static_cast<compute_t>(2));
+
+		return { static_cast<_Ty>(std::cos(phase)), static_cast<_Ty>(std::sin(phase)) };
+	}
+
+	template<typename _Ty>
+	template<typename _InIt, typename _OutIt>
+	inline void ChirpZTransform<_Ty>::Transform(_InIt first, _InIt last, double firstFrequency, _OutIt dest) noexcept
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		const compute_t omega		= static_cast<compute_t>(-2) * pi<compute_t> * static_cast<compute_t>(firstFrequency);
+		const compute_t rotationRe	= std::cos(omega);
+		const compute_t rotationIm	= std::sin(omega);
+
+		compute_t re = static_cast<compute_t>(1);
+		compute_t im = static_cast<compute_t>(0);
+
+		// Input shifted down by firstFrequency and multiplied by the chirp
+		for (size_t n = 0U; first != last; ++first, n++)
+		{
+			if (n % s_phasorBlockLength == 0U)
+			{
+				re = std::cos(omega * static_cast<compute_t>(n));
+				im = std::sin(omega * static_cast<compute_t>(n));
+			}
+
+			const complex_t chirp	= m_inputChirp[n];
+			const _Ty sample		= *first;
+			const _Ty shiftedRe		= sample * static_cast<_Ty>(re);
+			const _Ty shiftedIm		= sample * static_cast<_Ty>(im);
+
+			m_signal[n] = { shiftedRe * chirp.real() - shiftedIm * chirp.imag(), shiftedRe * chirp.imag() + shiftedIm * chirp.real() };
+
+			const compute_t nextRe	= re * rotationRe - im * rotationIm;
+			im						= re * rotationIm + im * rotationRe;
+			re						= nextRe;
+		}
+
+		// Result of the previous call past the input is zeroed again
+		std::fill(std::next(m_signal.begin(), m_inputSize), m_signal.end(), complex_t(0));
+
+		m_forwardPlan.Execute();
+
+		// Convolution with the chirp
+		MultiplyPointwise(m_spectrum.data(), m_spectrum.data() + m_spectrum.size(), m_kernelSpectrum.data(), m_spectrum.data());
+
+		m_inversePlan.Execute();
+
+		for (size_t k = 0U; k < m_binCount; k++, ++dest)
+		{
+			const complex_t value	= m_signal[k];
+			const complex_t chirp	= m_outputChirp[k];
+
+			*dest = complex_t(value.real() * chirp.real() - value.imag() * chirp.imag(), value.real() * chirp.imag() + value.imag() * chirp.real());
+		}
+	}
+}
@@ -1,8 +1,12 @@
 #pragma once
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <execution>
+#include <limits>
+#include <numeric>
 #include "DSPTypeTraits.h"
+#include "SIMDKernels.h"
 
 namespace DSP
 {
@@ -23,6 +27,16 @@ namespace DSP
 		return static_cast<T>(2) * pi<T> * f / fs;
 	}
 
+	// Below that length the loop is not worth dispatching to the SIMD kernels
+	inline constexpr size_t s_simdMinLength{ 64U };
+	// From that length on the work is split between threads
+	inline constexpr size_t s_parallelMinLength{ 1U << 20 };
+	// Number of elements processed by a single thread at a time
+	inline constexpr size_t s_parallelChunkLength{ 1U << 16 };
+
+	// Pointwise product of [first1, last1) and [first2, first2 + (last1 - first1)), written to dest.
+	// Pointers to float, double and their complex types use vectorized kernels, long arrays are
+	// additionally split between threads.
 	template<typename _FwdIt1, typename _FwdIt2, typename _FwdIt3>
 	inline void MultiplyPointwise(_FwdIt1 first1, _FwdIt1 last1, _FwdIt2 first2, _FwdIt3 dest)
 	{
@@ -31,6 +45,80 @@ namespace DSP
 		static_assert(Is_same<value_t, Iterator_value_type<_FwdIt2>>, "Different value types.");
 		static_assert(Is_same<value_t, Iterator_value_type<_FwdIt3>>, "Different value types.");
 
-		std::transform(std::execution::par, first1, last1, first2, dest, std::multiplies<value_t>());
+		const size_t count = static_cast<size_t>(std::distance(first1, last1));
+
+		if constexpr (std::is_pointer_v<_FwdIt1> && std::is_pointer_v<_FwdIt2> && std::is_pointer_v<_FwdIt3> && SIMD::Is_supported_type<value_t>)
+		{
+			if (count < s_simdMinLength)
+			{
+				SIMD::Detail::MultiplyScalar(first1, first2, dest, count);
+			}
+			else if (count < s_parallelMinLength)
+			{
+				SIMD::MultiplyPointwise(first1, first2, dest, count);
+			}
+			else
+			{
+				constexpr size_t maxChunkCount = 64U;
+
+				const size_t chunkCount		= std::min(maxChunkCount, count / s_parallelChunkLength);
+				const size_t chunkLength	= (count + chunkCount - 1U) / chunkCount;
+
+				std::array<size_t, maxChunkCount> chunks;
+				std::iota(chunks.begin(), std::next(chunks.begin(), chunkCount), size_t{ 0U });
+
+				std::for_each(std::execution::par, chunks.begin(), std::next(chunks.begin(), chunkCount), [=](size_t chunk) {
+					const size_t offset = chunk * chunkLength;
+					SIMD::MultiplyPointwise(first1 + offset, first2 + offset, dest + offset, std::min(chunkLength, count - offset));
+				});
+			}
+		}
+		else
+		{
+			if (count < s_parallelMinLength)
+			{
+				std::transform(first1, last1, first2, dest, std::multiplies<value_t>());
+			}
+			else
+			{
+				std::transform(std::execution::par, first1, last1, first2, dest, std::multiplies<value_t>());
+			}
+		}
+	}
+
+	// Squared magnitude of each bin of [first1, last1) multiplied by the real weight from
+	// [first2, first2 + (last1 - first1)), written to dest. Used to apply a filter given by
+	// its squared magnitude response in the same pass that computes the power spectrum.
+	template<typename _FwdIt1, typename _FwdIt2, typename _FwdIt3>
+	inline void WeightedPowerSpectrum(_FwdIt1 first1, _FwdIt1 last1, _FwdIt2 first2, _FwdIt3 dest)
+	{
+		using value_t = Iterator_value_type<_FwdIt2>;
+
+		static_assert(Is_value_type_complex<value_t, _FwdIt1>, "Spectrum value type must be std::complex of the weight type.");
+		static_assert(Is_same<value_t, Iterator_value_type<_FwdIt3>>, "Different value types.");
+
+		if constexpr (std::is_pointer_v<_FwdIt1> && std::is_pointer_v<_FwdIt2> && std::is_pointer_v<_FwdIt3> && (Is_float<value_t> || Is_double<value_t>))
+		{
+			SIMD::WeightedPower(first1, first2, dest, static_cast<size_t>(std::distance(first1, last1)));
+		}
+		else
+		{
+			std::transform(first1, last1, first2, dest, [](const auto& bin, value_t weight) { return std::norm(bin) * weight; });
+		}
+	}
+
+	// Natural logarithm of each element of [first, last), written to dest. Values are clamped
+	// to the smallest normal number first, so empty bins give a large negative value instead of -inf.
+	template<typename _FwdIt1, typename _FwdIt2>
+	inline void Logarithm(_FwdIt1 first, _FwdIt1 last, _FwdIt2 dest)
+	{
+		using value_t = Iterator_value_type<_FwdIt1>;
+
+		static_assert(Is_floating_point<value_t>, "Value type must be floating point.");
+		static_assert(Is_same<value_t, Iterator_value_type<_FwdIt2>>, "Different value types.");
+
+		std::transform(first, last, dest, [](value_t val) {
+			return std::log(std::max(val, std::numeric_limits<value_t>::min()));
+		});
 	}
 }
\ No newline at end of file
@@ -31,7 +31,7 @@ namespace DSP
 	inline constexpr bool Is_long_double = Is_same<_Ty, long double>;
 
 	template<typename _Ty, typename _It>
-	inline constexpr bool Is_value_type_complex = Is_same<std::complex<_Ty>, std::iterator_traits<_It>::value_type>;
+	inline constexpr bool Is_value_type_complex = Is_same<std::complex<_Ty>, Iterator_value_type<_It>>;
 
 	template<typename _It>
 	inline constexpr bool Is_value_type_floating_point = Is_floating_point<Iterator_value_type<_It>>;
@@ -44,21 +44,47 @@ namespace DSP
 	template<>
 	struct Fftw_plan<float>
 	{
-		using type = typename fftwf_plan;
+		using type = fftwf_plan;
 	};
 
 	template<>
 	struct Fftw_plan<double>
 	{
-		using type = typename fftw_plan;
+		using type = fftw_plan;
 	};
 
 	template<>
 	struct Fftw_plan<long double>
 	{
-		using type = typename fftwl_plan;
+		using type = fftwl_plan;
 	};
 
 	template<typename _Ty>
 	using fftw_plan_type = typename Fftw_plan<_Ty>::type;
+
+	template<typename _Ty>
+	struct Fftw_complex
+	{
+	};
+
+	template<>
+	struct Fftw_complex<float>
+	{
+		using type = fftwf_complex;
+	};
+
+	template<>
+	struct Fftw_complex<double>
+	{
+		using type = fftw_complex;
+	};
+
+	template<>
+	struct Fftw_complex<long double>
+	{
+		using type = fftwl_complex;
+	};
+
+	template<typename _Ty>
+	using fftw_complex_type = typename Fftw_complex<_Ty>::type;
 }
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
-#include <winrt/Windows.Foundation.h>
-#include <winrt/Windows.Storage.h>
-#include <hstring.h>
 #include <cstdint>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include "fftw3.h"
@@ -15,9 +16,23 @@ namespace DSP
 	{
 		static uint32_t s_refCount;
 	public:
-		FFTManager() { s_refCount++; }
+		// FFTW planner of each precision is not thread safe, creating and destroying plans,
+		// wisdom and cleanup are serialized. Executing plans does not need the lock.
+		static std::mutex& GetPlannerMutex() noexcept
+		{
+			static std::mutex plannerMutex;
+			return plannerMutex;
+		}
+
+		FFTManager() 
+		{
+			std::lock_guard<std::mutex> lock{ GetPlannerMutex() };
+			s_refCount++;
+		}
+
 		~FFTManager() 
 		{
+			std::lock_guard<std::mutex> lock{ GetPlannerMutex() };
 			s_refCount--;
 
 			if (s_refCount == 0U)
@@ -43,8 +58,61 @@ namespace DSP
 
 	enum class flags
 	{
-		measure = FFTW_MEASURE,
-		wisdom	= FFTW_WISDOM_ONLY
+		measure		= FFTW_MEASURE,
+		wisdom		= FFTW_WISDOM_ONLY,
+		// Plan chosen by heuristics without running any transform, created instantly
+		// and does not overwrite the arrays
+		estimate	= FFTW_ESTIMATE
+	};
+
+	// Smallest size not less than minSize whose only prime factors are 2, 3 and 5. FFTW is much
+	// faster on such sizes than on sizes with large prime factors, zero-padding to them is cheaper.
+	inline constexpr size_t NextFastFFTSize(size_t minSize) noexcept
+	{
+		size_t size = minSize > 1U ? minSize : 1U;
+
+		while (true)
+		{
+			size_t remainder = size;
+
+			for (const size_t factor : { 2U, 3U, 5U })
+			{
+				while (remainder % factor == 0U)
+				{
+					remainder /= factor;
+				}
+			}
+
+			if (remainder == 1U)
+			{
+				return size;
+			}
+
+			size++;
+		}
+	}
+
+	// Sign of the exponent of complex-to-complex transforms
+	enum class direction
+	{
+		forward		= FFTW_FORWARD,
+		backward	= FFTW_BACKWARD
+	};
+
+	// Layout of transforms computed together by a single plan. Transform k reads its input
+	// from index k * inputDistance, elements inputStride apart, and writes its output the same
+	// way, all counted in elements of the respective array. Values must fit in int, as the planner
+	// takes them.
+	struct BatchLayout
+	{
+		// Number of points of each transform, length of the real signal for real transforms
+		size_t	fftSize;
+		// Number of transforms
+		size_t	count;
+		size_t	inputDistance;
+		size_t	outputDistance;
+		size_t	inputStride{ 1U };
+		size_t	outputStride{ 1U };
 	};
 
 	template<typename _Ty>
@@ -54,8 +122,21 @@ namespace DSP
 
 		fftw_plan_type<_Ty> m_fftPlan;
 
+		// Sizes, strides and distances of the planner are int
+		static int ToPlannerInt(size_t value)
+		{
+			if (value > static_cast<size_t>(std::numeric_limits<int>::max()))
+			{
+				throw std::invalid_argument("Batch layout exceeds the range of the FFTW planner.");
+			}
+
+			return static_cast<int>(value);
+		}
+
 		void DestroyPlan() noexcept
 		{
+			std::lock_guard<std::mutex> lock{ FFTManager<_Ty>::GetPlannerMutex() };
+
 			if constexpr (Is_float<_Ty>)
 			{
 				fftwf_destroy_plan(m_fftPlan);
@@ -74,61 +155,67 @@ namespace DSP
 
 	public:
 
-		static winrt::Windows::Foundation::IAsyncOperation<bool> LoadFFTPlan(winrt::hstring fileName) noexcept
+		// Merge wisdom exported by ExportWisdom() into the wisdom of this precision.
+		// Returns false if it could not be parsed.
+		static bool ImportWisdom(const std::string& wisdom) noexcept
 		{
-			using namespace winrt::Windows::Storage;
+			std::lock_guard<std::mutex> lock{ FFTManager<_Ty>::GetPlannerMutex() };
 
-			StorageFolder storageFolder = ApplicationData::Current().LocalFolder();
-			IStorageItem storageItem = co_await storageFolder.TryGetItemAsync(fileName);
-
-			if (!storageItem)
+			if constexpr (Is_float<_Ty>)
 			{
-				co_return false;
+				return fftwf_import_wisdom_from_string(wisdom.c_str()) != 0;
 			}
+			else if constexpr (Is_double<_Ty>)
+			{
+				return fftw_import_wisdom_from_string(wisdom.c_str()) != 0;
+			}
+			else if constexpr (Is_long_double<_Ty>)
+			{
+				return fftwl_import_wisdom_from_string(wisdom.c_str()) != 0;
+			}
+		}
 
-			StorageFile file = storageItem.as<StorageFile>();
-			std::string fftPlanBuffer = winrt::to_string(co_await FileIO::ReadTextAsync(file));
+		// Export wisdom of all plans of this precision created so far
+		static std::string ExportWisdom()
+		{
+			std::lock_guard<std::mutex> lock{ FFTManager<_Ty>::GetPlannerMutex() };
+
+			char* wisdomRaw = nullptr;
 
 			if constexpr (Is_float<_Ty>)
 			{
-				fftwf_import_wisdom_from_string(fftPlanBuffer.c_str());
+				wisdomRaw = fftwf_export_wisdom_to_string();
 			}
 			else if constexpr (Is_double<_Ty>)
 			{
-				fftw_import_wisdom_from_string(fftPlanBuffer.c_str());
+				wisdomRaw = fftw_export_wisdom_to_string();
 			}
 			else if constexpr (Is_long_double<_Ty>)
 			{
-				fftwl_import_wisdom_from_string(fftPlanBuffer.c_str());
+				wisdomRaw = fftwl_export_wisdom_to_string();
 			}
 
-			co_return true;
-		}
-
-		winrt::Windows::Foundation::IAsyncAction SaveFFTPlan(winrt::hstring fileName) const noexcept
-		{
-			using namespace winrt::Windows::Storage;
+			if (!wisdomRaw)
+			{
+				return {};
+			}
 
-			char* fftPlanBufferRaw = nullptr;
+			std::string wisdom{ wisdomRaw };
 
 			if constexpr (Is_float<_Ty>)
 			{
-				fftPlanBufferRaw = fftwf_export_wisdom_to_string();
+				fftwf_free(wisdomRaw);
 			}
 			else if constexpr (Is_double<_Ty>)
 			{
-				fftPlanBufferRaw = fftw_export_wisdom_to_string();
+				fftw_free(wisdomRaw);
 			}
 			else if constexpr (Is_long_double<_Ty>)
 			{
-				fftPlanBufferRaw = fftwl_export_wisdom_to_string();
+				fftwl_free(wisdomRaw);
 			}
 
-			winrt::hstring fftPlanBuffer = winrt::to_hstring(fftPlanBufferRaw);
-
-			StorageFolder storageFolder = ApplicationData::Current().LocalFolder();
-			StorageFile file = co_await storageFolder.CreateFileAsync(fileName, CreationCollisionOption::ReplaceExisting);
-			co_await FileIO::WriteTextAsync(file, fftPlanBuffer);
+			return wisdom;
 		}
 
 		FFTPlan() : m_fftPlan{ nullptr } 
@@ -140,28 +227,158 @@ namespace DSP
 			*this = std::move(other);
 		}
 
+		// Real input [_First, _Last) creates a forward real-to-complex plan writing _Last - _First / 2 + 1 bins.
+		// Complex input [_First, _Last) holding a half spectrum creates an inverse complex-to-real plan writing
+		// 2 * (_Last - _First - 1) samples. Inverse transform is not normalized and overwrites its input.
+		// Complex input and output create a complex-to-complex plan in the given direction.
 		template<typename _InIt1, typename _InIt2>
-		FFTPlan(_InIt1 _First, _InIt1 _Last, _InIt2 _Dest, flags _flags = flags::measure) : m_fftPlan{ nullptr }
+		FFTPlan(_InIt1 _First, _InIt1 _Last, _InIt2 _Dest, flags _flags = flags::measure, direction _direction = direction::forward) : m_fftPlan{ nullptr }
 		{
-			static_assert(Is_value_type_floating_point<_InIt1>, "Value type must be floating point.");
-			static_assert(Is_same<Iterator_value_type<_InIt1>, _Ty>, "Floating point types does not match.");
-			static_assert(Is_value_type_complex<_Ty, _InIt2>, "Value type in destination iterator must be of std::complex<_Ty> type.");
+			std::lock_guard<std::mutex> lock{ FFTManager<_Ty>::GetPlannerMutex() };
 
-			using diff_t = Iterator_difference_type<_InIt1>;
+			if constexpr (Is_value_type_complex<_Ty, _InIt1> && Is_value_type_complex<_Ty, _InIt2>)
+			{
+				const int fftSize	= static_cast<int>(std::distance(_First, _Last));
+				auto input			= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_First));
+				auto output			= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_Dest));
+
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_dft_1d(fftSize, input, output, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_dft_1d(fftSize, input, output, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_dft_1d(fftSize, input, output, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+			}
+			else if constexpr (Is_value_type_complex<_Ty, _InIt1>)
+			{
+				static_assert(Is_same<Iterator_value_type<_InIt2>, _Ty>, "Value type in destination iterator must be _Ty.");
 
-			const diff_t fftSize = std::distance(_First, _Last) / static_cast<diff_t>(2) + static_cast<diff_t>(1);
+				// Complex-to-real plan is defined by the length of its real output
+				const int fftSize = 2 * (static_cast<int>(std::distance(_First, _Last)) - 1);
 
-			if constexpr (Is_float<_Ty>)
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_dft_c2r_1d(fftSize, reinterpret_cast<fftwf_complex*>(&(*_First)), &(*_Dest), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_dft_c2r_1d(fftSize, reinterpret_cast<fftw_complex*>(&(*_First)), &(*_Dest), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_dft_c2r_1d(fftSize, reinterpret_cast<fftwl_complex*>(&(*_First)), &(*_Dest), static_cast<int>(_flags));
+				}
+			}
+			else
 			{
-				m_fftPlan = fftwf_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftwf_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				static_assert(Is_value_type_floating_point<_InIt1>, "Value type must be floating point.");
+				static_assert(Is_same<Iterator_value_type<_InIt1>, _Ty>, "Floating point types does not match.");
+				static_assert(Is_value_type_complex<_Ty, _InIt2>, "Value type in destination iterator must be of std::complex<_Ty> type.");
+
+				// Real-to-complex plan is defined by the length of its real input
+				const int fftSize = static_cast<int>(std::distance(_First, _Last));
+
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftwf_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftw_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftwl_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				}
 			}
-			else if constexpr (Is_double<_Ty>)
+		}
+
+		// Plan of layout.count transforms computed by a single Execute() on the arrays starting at _First
+		// and _Dest, which saves the per-call overhead and lets FFTW interleave the transforms. Kind of
+		// the transform is selected by the value types as in the constructor above.
+		template<typename _InIt1, typename _InIt2>
+		FFTPlan(const BatchLayout& layout, _InIt1 _First, _InIt2 _Dest, flags _flags = flags::measure, direction _direction = direction::forward) : m_fftPlan{ nullptr }
+		{
+			if (layout.fftSize == 0U || layout.count == 0U)
 			{
-				m_fftPlan = fftw_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftw_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				throw std::invalid_argument("Batch must hold at least one non-empty transform.");
 			}
-			else if constexpr (Is_long_double<_Ty>)
+
+			const int fftSize			= ToPlannerInt(layout.fftSize);
+			const int count				= ToPlannerInt(layout.count);
+			const int inputDistance		= ToPlannerInt(layout.inputDistance);
+			const int outputDistance	= ToPlannerInt(layout.outputDistance);
+			const int inputStride		= ToPlannerInt(layout.inputStride);
+			const int outputStride		= ToPlannerInt(layout.outputStride);
+
+			std::lock_guard<std::mutex> lock{ FFTManager<_Ty>::GetPlannerMutex() };
+
+			// Arrays are not embedded in larger ones (nullptr), strides and distances alone describe them
+			if constexpr (Is_value_type_complex<_Ty, _InIt1> && Is_value_type_complex<_Ty, _InIt2>)
 			{
-				m_fftPlan = fftwl_plan_dft_r2c_1d(fftSize, &(*_First), reinterpret_cast<fftwl_complex*>(&(*_Dest)), static_cast<int>(_flags));
+				auto input	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_First));
+				auto output	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_Dest));
+
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_many_dft(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_many_dft(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_many_dft(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_direction), static_cast<int>(_flags));
+				}
+			}
+			else if constexpr (Is_value_type_complex<_Ty, _InIt1>)
+			{
+				static_assert(Is_same<Iterator_value_type<_InIt2>, _Ty>, "Value type in destination iterator must be _Ty.");
+
+				auto input	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_First));
+				auto output	= &(*_Dest);
+
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_many_dft_c2r(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_many_dft_c2r(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_many_dft_c2r(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
+			}
+			else
+			{
+				static_assert(Is_value_type_floating_point<_InIt1>, "Value type must be floating point.");
+				static_assert(Is_same<Iterator_value_type<_InIt1>, _Ty>, "Floating point types does not match.");
+				static_assert(Is_value_type_complex<_Ty, _InIt2>, "Value type in destination iterator must be of std::complex<_Ty> type.");
+
+				auto input	= &(*_First);
+				auto output	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_Dest));
+
+				if constexpr (Is_float<_Ty>)
+				{
+					m_fftPlan = fftwf_plan_many_dft_r2c(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					m_fftPlan = fftw_plan_many_dft_r2c(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					m_fftPlan = fftwl_plan_many_dft_r2c(1, &fftSize, count, input, nullptr, inputStride, inputDistance, output, nullptr, outputStride, outputDistance, static_cast<int>(_flags));
+				}
 			}
 		}
 
@@ -193,6 +410,40 @@ namespace DSP
 			return m_fftPlan;
 		}
 
+		// Exchange plans without creating or destroying any, e.g. on a real-time thread
+		void Swap(FFTPlan& other) noexcept
+		{
+			std::swap(m_fftPlan, other.m_fftPlan);
+		}
+
+		// Number of floating point operations of one execution, fused multiply-adds count as two
+		double GetFlops() const noexcept
+		{
+			double additions		= 0.0;
+			double multiplications	= 0.0;
+			double fusedOperations	= 0.0;
+
+			if (!m_fftPlan)
+			{
+				return 0.0;
+			}
+
+			if constexpr (Is_float<_Ty>)
+			{
+				fftwf_flops(m_fftPlan, &additions, &multiplications, &fusedOperations);
+			}
+			else if constexpr (Is_double<_Ty>)
+			{
+				fftw_flops(m_fftPlan, &additions, &multiplications, &fusedOperations);
+			}
+			else if constexpr (Is_long_double<_Ty>)
+			{
+				fftwl_flops(m_fftPlan, &additions, &multiplications, &fusedOperations);
+			}
+
+			return additions + multiplications + 2.0 * fusedOperations;
+		}
+
 		void Execute() const
 		{
 #ifdef _DEBUG
@@ -216,13 +467,21 @@ namespace DSP
 			}
 		}
 
+		// Execute the plan on other arrays of the same size and alignment. Direction of the
+		// plan must match the one it was created with.
 		template<typename _InIt1, typename _InIt2>
 		void Execute(_InIt1 _First, _InIt1 _Last, _InIt2 _Dest) const
 		{
-			static_assert(Is_value_type_floating_point<_InIt1>, "Value type must be floating point.");
-			static_assert(Is_same<Iterator_value_type<_InIt1>, _Ty>, "Floating point types does not match.");
-			static_assert(Is_value_type_complex<_Ty, _InIt2>, "Value type in destination iterator must be of std::complex<_Ty> type.");
+			// Size is fixed by the plan
+			static_cast<void>(_Last);
+			Execute(_First, _Dest);
+		}
 
+		// Execute the plan on other arrays starting at _First and _Dest, of the same size, layout
+		// and alignment. Kind and direction of the transform must match the ones of the plan.
+		template<typename _InIt1, typename _InIt2>
+		void Execute(_InIt1 _First, _InIt2 _Dest) const
+		{
 #ifdef _DEBUG
 			if (!m_fftPlan)
 			{
@@ -230,17 +489,59 @@ namespace DSP
 			}
 #endif
 
-			if constexpr (Is_float<_Ty>)
+			if constexpr (Is_value_type_complex<_Ty, _InIt1> && Is_value_type_complex<_Ty, _InIt2>)
 			{
-				fftwf_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftwf_complex*>(&(*_Dest)));
+				auto input	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_First));
+				auto output	= reinterpret_cast<fftw_complex_type<_Ty>*>(&(*_Dest));
+
+				if constexpr (Is_float<_Ty>)
+				{
+					fftwf_execute_dft(m_fftPlan, input, output);
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					fftw_execute_dft(m_fftPlan, input, output);
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					fftwl_execute_dft(m_fftPlan, input, output);
+				}
 			}
-			else if constexpr (Is_double<_Ty>)
+			else if constexpr (Is_value_type_complex<_Ty, _InIt1>)
 			{
-				fftw_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftw_complex*>(&(*_Dest)));
+				static_assert(Is_same<Iterator_value_type<_InIt2>, _Ty>, "Value type in destination iterator must be _Ty.");
+
+				if constexpr (Is_float<_Ty>)
+				{
+					fftwf_execute_dft_c2r(m_fftPlan, reinterpret_cast<fftwf_complex*>(&(*_First)), &(*_Dest));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					fftw_execute_dft_c2r(m_fftPlan, reinterpret_cast<fftw_complex*>(&(*_First)), &(*_Dest));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					fftwl_execute_dft_c2r(m_fftPlan, reinterpret_cast<fftwl_complex*>(&(*_First)), &(*_Dest));
+				}
 			}
-			else if constexpr (Is_long_double<_Ty>)
+			else
 			{
-				fftwl_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftwl_complex*>(&(*_Dest)));
+				static_assert(Is_value_type_floating_point<_InIt1>, "Value type must be floating point.");
+				static_assert(Is_same<Iterator_value_type<_InIt1>, _Ty>, "Floating point types does not match.");
+				static_assert(Is_value_type_complex<_Ty, _InIt2>, "Value type in destination iterator must be of std::complex<_Ty> type.");
+
+				if constexpr (Is_float<_Ty>)
+				{
+					fftwf_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftwf_complex*>(&(*_Dest)));
+				}
+				else if constexpr (Is_double<_Ty>)
+				{
+					fftw_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftw_complex*>(&(*_Dest)));
+				}
+				else if constexpr (Is_long_double<_Ty>)
+				{
+					fftwl_execute_dft_r2c(m_fftPlan, &(*_First), reinterpret_cast<fftwl_complex*>(&(*_Dest)));
+				}
 			}
 		}
 
@@ -0,0 +1,123 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "WindowGenerator.h"
+
+namespace DSP
+{
+	// Parameters of a band-pass FIR filter generated by GenerateBandPassFIR
+	struct FilterDesign
+	{
+		float						lowCutoff;
+		float						highCutoff;
+		float						samplingFrequency;
+		WindowGenerator::WindowType	windowType;
+		// Number of taps
+		size_t						filterSize;
+	};
+
+	inline bool operator==(const FilterDesign& lhs, const FilterDesign& rhs) noexcept
+	{
+		return lhs.lowCutoff == rhs.lowCutoff && lhs.highCutoff == rhs.highCutoff && lhs.samplingFrequency == rhs.samplingFrequency &&
+			lhs.windowType == rhs.windowType && lhs.filterSize == rhs.filterSize;
+	}
+
+	inline bool operator!=(const FilterDesign& lhs, const FilterDesign& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+
+	// Least recently used filters, e.g. frequency responses, keyed by their design. Entries are
+	// immutable and shared, so a filter found in the cache stays valid after it is evicted.
+	// Holds a few entries searched linearly, not synchronized.
+	template<typename _Ty>
+	class FilterCache
+	{
+		using Entry = std::pair<FilterDesign, std::shared_ptr<const _Ty>>;
+
+		// Most recently used first
+		std::list<Entry>	m_entries;
+		size_t				m_capacity;
+
+	public:
+
+		explicit FilterCache(size_t capacity);
+
+		// Get the filter of the design and mark it most recently used, nullptr if it is not cached
+		std::shared_ptr<const _Ty> Find(const FilterDesign& design);
+
+		// Add or replace the filter of the design, evicting the least recently used one when full
+		void Insert(const FilterDesign& design, std::shared_ptr<const _Ty> filter);
+
+		void Clear() noexcept;
+
+		size_t GetSize() const noexcept;
+		size_t GetCapacity() const noexcept;
+	};
+
+	template<typename _Ty>
+	inline FilterCache<_Ty>::FilterCache(size_t capacity) :
+		m_capacity{ capacity }
+	{
+		if (capacity == 0U)
+		{
+			throw std::invalid_argument("Cache capacity must be positive.");
+		}
+	}
+
+	template<typename _Ty>
+	inline std::shared_ptr<const _Ty> FilterCache<_Ty>::Find(const FilterDesign& design)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+		{
+			if (it->first == design)
+			{
+				m_entries.splice(m_entries.begin(), m_entries, it);
+				return it->second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	template<typename _Ty>
+	inline void FilterCache<_Ty>::Insert(const FilterDesign& design, std::shared_ptr<const _Ty> filter)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+		{
+			if (it->first == design)
+			{
+				it->second = std::move(filter);
+				m_entries.splice(m_entries.begin(), m_entries, it);
+				return;
+			}
+		}
+
+		if (m_entries.size() == m_capacity)
+		{
+			m_entries.pop_back();
+		}
+
+		m_entries.emplace_front(design, std::move(filter));
+	}
+
+	template<typename _Ty>
+	inline void FilterCache<_Ty>::Clear() noexcept
+	{
+		m_entries.clear();
+	}
+
+	template<typename _Ty>
+	inline size_t FilterCache<_Ty>::GetSize() const noexcept
+	{
+		return m_entries.size();
+	}
+
+	template<typename _Ty>
+	inline size_t FilterCache<_Ty>::GetCapacity() const noexcept
+	{
+		return m_capacity;
+	}
+}
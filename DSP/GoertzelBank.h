@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "DSPMath.h"
+#include "DSPTypeTraits.h"
+#include "SIMDKernels.h"
+
+namespace DSP
+{
+	// Bank of Goertzel filters evaluating the power spectrum of a block only at the given frequencies.
+	// A frequency costs a multiply-add per sample, so a few of them are cheaper than an FFT, and any
+	// frequency may be evaluated, not only the FFT bins. Filters run side by side, the SIMD kernel
+	// updates a register of them per instruction. Frequencies are given as fractions of the sampling
+	// frequency.
+	template<typename _Ty>
+	class GoertzelBank
+	{
+		static_assert(Is_float<_Ty> || Is_double<_Ty>, "Value type must be float or double.");
+
+		// 2 * cos(2 * pi * frequency) of each filter
+		std::vector<_Ty>	m_coefficients;
+		std::vector<_Ty>	m_state1;
+		std::vector<_Ty>	m_state2;
+		// Input copied when it is not contiguous
+		std::vector<_Ty>	m_samples;
+
+	public:
+
+		// Empty bank, evaluates no frequency
+		GoertzelBank() noexcept = default;
+
+		// Bank of the frequencies in [first, last), in range [0, 0.5]
+		template<typename _InIt>
+		GoertzelBank(_InIt first, _InIt last);
+
+		// Get number of evaluated frequencies
+		size_t GetSize() const noexcept;
+
+		// Compute |X(f)|^2 of [first, last) at each frequency, writing GetSize() values to dest
+		template<typename _InIt, typename _OutIt>
+		void Power(_InIt first, _InIt last, _OutIt dest);
+	};
+
+	template<typename _Ty>
+	template<typename _InIt>
+	inline GoertzelBank<_Ty>::GoertzelBank(_InIt first, _InIt last)
+	{
+		for (; first != last; ++first)
+		{
+			const double frequency = static_cast<double>(*first);
+
+			if (!(frequency >= 0.0 && frequency <= 0.5))
+			{
+				throw std::invalid_argument("Frequencies must be in range [0, 0.5] of the sampling frequency.");
+			}
+
+			m_coefficients.push_back(static_cast<_Ty>(2.0 * std::cos(2.0 * pi<double> * frequency)));
+		}
+
+		m_state1.resize(m_coefficients.size());
+		m_state2.resize(m_coefficients.size());
+	}
+
+	template<typename _Ty>
+	inline size_t GoertzelBank<_Ty>::GetSize() const noexcept
+	{
+		return m_coefficients.size();
+	}
+
+	template<typename _Ty>
+	template<typename _InIt, typename _OutIt>
+	inline void GoertzelBank<_Ty>::Power(_InIt first, _InIt last, _OutIt dest)
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		const _Ty* samples = nullptr;
+		size_t sampleCount = 0U;
+
+		if constexpr (std::is_pointer_v<_InIt>)
+		{
+			samples		= first;
+			sampleCount	= static_cast<size_t>(std::distance(first, last));
+		}
+		else
+		{
+			m_samples.assign(first, last);
+			samples		= m_samples.data();
+			sampleCount	= m_samples.size();
+		}
+
+		std::fill(m_state1.begin(), m_state1.end(), static_cast<_Ty>(0));
+		std::fill(m_state2.begin(), m_state2.end(), static_cast<_Ty>(0));
+
+		SIMD::GoertzelRecurrence(samples, sampleCount, m_coefficients.data(), m_state1.data(), m_state2.data(), m_coefficients.size());
+
+		// |s[N - 1] - exp(-i * omega) * s[N - 2]|^2, the magnitude of the DFT at omega
+		for (size_t k = 0U; k < m_coefficients.size(); k++, ++dest)
+		{
+			const _Ty s1 = m_state1[k];
+			const _Ty s2 = m_state2[k];
+
+			*dest = s1 * s1 + s2 * s2 - m_coefficients[k] * s1 * s2;
+		}
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "DSPTypeTraits.h"
+
+namespace DSP
+{
+	// Scale of the spectrum passed to HarmonicProductSpectrum
+	enum class SpectrumScale
+	{
+		// Magnitude or squared magnitude, harmonics are multiplied
+		linear,
+		// Logarithm of the magnitude or squared magnitude, harmonics are added
+		logarithmic
+	};
+
+	// Harmonic Product Spectrum pitch detector working on a precomputed spectrum. For each
+	// candidate fundamental bin n it combines bins n, 2n, ..., Hn, where H is the harmonic count.
+	// Harmonics are accumulated one at a time over the whole candidate range, i.e. the spectrum
+	// is decimated by h and added to a contiguous score array, so the cost grows with H by a
+	// single strided pass instead of H random accesses per candidate.
+	template<typename _Ty>
+	class HarmonicProductSpectrum
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		// Combined harmonics of each candidate fundamental
+		std::vector<_Ty>	m_scores;
+		size_t				m_harmonicCount;
+		SpectrumScale		m_scale;
+
+	public:
+
+		static constexpr size_t s_defaultHarmonicCount{ 3U };
+
+		// Detector for spectra of up to maxBinCount bins
+		explicit HarmonicProductSpectrum(size_t maxBinCount, size_t harmonicCount = s_defaultHarmonicCount, SpectrumScale scale = SpectrumScale::logarithmic);
+
+		// Set number of harmonics combined for each candidate, at least 1
+		void SetHarmonicCount(size_t harmonicCount);
+
+		// Get number of harmonics combined for each candidate
+		size_t GetHarmonicCount() const noexcept;
+
+		// Set scale of the spectra passed to FindFundamental
+		void SetScale(SpectrumScale scale) noexcept;
+
+		// Find the bin of the strongest fundamental in spectrum [first, last). Candidates start at
+		// minBin and end where their highest harmonic would fall outside of the spectrum.
+		// Returns 0 if there are no candidates.
+		template<typename _RanIt>
+		size_t FindFundamental(_RanIt first, _RanIt last, size_t minBin) noexcept;
+	};
+
+	template<typename _Ty>
+	inline HarmonicProductSpectrum<_Ty>::HarmonicProductSpectrum(size_t maxBinCount, size_t harmonicCount, SpectrumScale scale) :
+		m_scores		( maxBinCount ),
+		m_harmonicCount	{ s_defaultHarmonicCount },
+		m_scale			{ scale }
+	{
+		SetHarmonicCount(harmonicCount);
+	}
+
+	template<typename _Ty>
+	inline void HarmonicProductSpectrum<_Ty>::SetHarmonicCount(size_t harmonicCount)
+	{
+		if (harmonicCount == 0U)
+		{
+			throw std::invalid_argument("Harmonic count must be positive.");
+		}
+
+		m_harmonicCount = harmonicCount;
+	}
+
+	template<typename _Ty>
+	inline size_t HarmonicProductSpectrum<_Ty>::GetHarmonicCount() const noexcept
+	{
+		return m_harmonicCount;
+	}
+
+	template<typename _Ty>
+	inline void HarmonicProductSpectrum<_Ty>::SetScale(SpectrumScale scale) noexcept
+	{
+		m_scale = scale;
+	}
+
+	template<typename _Ty>
+	template<typename _RanIt>
+	inline size_t HarmonicProductSpectrum<_Ty>::FindFundamental(_RanIt first, _RanIt last, size_t minBin) noexcept
+	{
+		using diff_t = typename std::iterator_traits<_RanIt>::difference_type;
+
+		static_assert(Is_same<Iterator_value_type<_RanIt>, _Ty>, "Different value types.");
+
+		const size_t binCount = std::min(static_cast<size_t>(std::distance(first, last)), m_scores.size());
+
+		if (binCount == 0U)
+		{
+			return 0U;
+		}
+
+		// Candidate n is valid while its highest harmonic n * H is below binCount
+		const size_t candidateLast = (binCount - 1U) / m_harmonicCount + 1U;
+
+		if (minBin >= candidateLast)
+		{
+			return 0U;
+		}
+
+		const size_t candidateCount	= candidateLast - minBin;
+		_Ty* scores					= m_scores.data();
+
+		// First harmonic is the candidate itself
+		std::copy(std::next(first, static_cast<diff_t>(minBin)), std::next(first, static_cast<diff_t>(candidateLast)), scores);
+
+		for (size_t harmonic = 2U; harmonic <= m_harmonicCount; harmonic++)
+		{
+			// Spectrum decimated by the harmonic number, starting at the harmonic of the first candidate
+			const _RanIt decimated = std::next(first, static_cast<diff_t>(harmonic * minBin));
+
+			if (m_scale == SpectrumScale::logarithmic)
+			{
+				for (size_t i = 0U; i < candidateCount; i++)
+				{
+					scores[i] += decimated[static_cast<diff_t>(harmonic * i)];
+				}
+			}
+			else
+			{
+				for (size_t i = 0U; i < candidateCount; i++)
+				{
+					scores[i] *= decimated[static_cast<diff_t>(harmonic * i)];
+				}
+			}
+		}
+
+		const _Ty* highestScore = std::max_element(scores, scores + candidateCount);
+
+		// No energy at all in the linear spectrum
+		if (m_scale == SpectrumScale::linear && *highestScore <= static_cast<_Ty>(0))
+		{
+			return 0U;
+		}
+
+		return minBin + static_cast<size_t>(highestScore - scores);
+	}
+}
@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <complex>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "DSPTypeTraits.h"
+#include "FFTPlan.h"
+#include "PeakInterpolation.h"
+
+namespace DSP
+{
+	// Period found by a time-domain pitch detector
+	template<typename _Ty>
+	struct PitchPeriod
+	{
+		// Period in samples, 0 if no pitch was found
+		double	period;
+		// Height of the normalized autocorrelation peak, 1 for a perfectly periodic signal
+		_Ty		clarity;
+	};
+
+	// McLeod Pitch Method. The normalized square difference function (NSDF) of the input is
+	// computed from its autocorrelation, which in turn is computed as the inverse FFT of the
+	// power spectrum of the zero-padded input. The first maximum of the NSDF reaching the
+	// threshold relative to the highest one gives the period. Works reliably on windows of
+	// two to three periods of the lowest detected tone.
+	template<typename _Ty>
+	class McLeodPitchMethod
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		using complex_t = std::complex<_Ty>;
+
+		// Input zero-padded to twice its length, so the circular autocorrelation is linear
+		std::vector<_Ty>		m_signal;
+		std::vector<complex_t>	m_spectrum;
+		// Autocorrelation, normalized in place to the NSDF
+		std::vector<_Ty>		m_nsdf;
+		// Lags of the highest NSDF value between each pair of zero crossings
+		std::vector<size_t>		m_keyMaxima;
+
+		FFTPlan<_Ty>			m_forwardPlan;
+		FFTPlan<_Ty>			m_inversePlan;
+
+		size_t					m_windowSize;
+		_Ty						m_threshold;
+
+	public:
+
+		static constexpr _Ty s_defaultThreshold{ static_cast<_Ty>(0.9) };
+
+		// Empty detector, has to be replaced by a constructed one before use
+		McLeodPitchMethod() noexcept;
+
+		// Detector for windows of windowSize samples, at least 4. FFT plans are created with the given flags,
+		// the detector evaluates to false if flags::wisdom was passed and no wisdom was found.
+		explicit McLeodPitchMethod(size_t windowSize, flags _flags = flags::measure);
+
+		McLeodPitchMethod(McLeodPitchMethod&&)				= default;
+		McLeodPitchMethod& operator=(McLeodPitchMethod&&)	= default;
+
+		McLeodPitchMethod(const McLeodPitchMethod&)				= delete;
+		McLeodPitchMethod& operator=(const McLeodPitchMethod&)	= delete;
+
+		// Check if FFT plans were created
+		explicit operator bool() const noexcept;
+
+		// Get number of samples analyzed at once
+		size_t GetWindowSize() const noexcept;
+
+		// Set fraction of the highest NSDF maximum the chosen one must reach, in range (0, 1]
+		void SetThreshold(_Ty threshold);
+
+		// Find the period of the signal in [first, last), which must hold exactly GetWindowSize() samples.
+		// Only periods in range [minLag, maxLag] samples are considered, maxLag should not exceed
+		// half of the window so that at least two periods are analyzed.
+		template<typename _InIt>
+		PitchPeriod<_Ty> FindPeriod(_InIt first, _InIt last, size_t minLag, size_t maxLag) noexcept;
+	};
+
+	template<typename _Ty>
+	inline McLeodPitchMethod<_Ty>::McLeodPitchMethod() noexcept :
+		m_windowSize	{ 0U },
+		m_threshold		{ s_defaultThreshold }
+	{
+	}
+
+	template<typename _Ty>
+	inline McLeodPitchMethod<_Ty>::McLeodPitchMethod(size_t windowSize, flags _flags) :
+		m_signal		( 2U * windowSize, static_cast<_Ty>(0) ),
+		m_spectrum		( windowSize + 1U ),
+		m_nsdf			( 2U * windowSize ),
+		m_windowSize	{ windowSize },
+		m_threshold		{ s_defaultThreshold }
+	{
+		if (windowSize < 4U)
+		{
+			throw std::invalid_argument("Window size must be at least 4 samples.");
+		}
+
+		m_keyMaxima.reserve(windowSize / 2U + 1U);
+
+		m_forwardPlan = FFTPlan<_Ty>(m_signal.begin(), m_signal.end(), m_spectrum.begin(), _flags);
+		m_inversePlan = FFTPlan<_Ty>(m_spectrum.begin(), m_spectrum.end(), m_nsdf.begin(), _flags);
+
+		// Measuring the plans overwrites the arrays
+		std::fill(m_signal.begin(), m_signal.end(), static_cast<_Ty>(0));
+	}
+
+	template<typename _Ty>
+	inline McLeodPitchMethod<_Ty>::operator bool() const noexcept
+	{
+		return m_forwardPlan && m_inversePlan;
+	}
+
+	template<typename _Ty>
+	inline size_t McLeodPitchMethod<_Ty>::GetWindowSize() const noexcept
+	{
+		return m_windowSize;
+	}
+
+	template<typename _Ty>
+	inline void McLeodPitchMethod<_Ty>::SetThreshold(_Ty threshold)
+	{
+		if (!(threshold > static_cast<_Ty>(0) && threshold <= static_cast<_Ty>(1)))
+		{
+			throw std::invalid_argument("Threshold must be in range (0, 1].");
+		}
+
+		m_threshold = threshold;
+	}
+
+	template<typename _Ty>
+	template<typename _InIt>
+	inline PitchPeriod<_Ty> McLeodPitchMethod<_Ty>::FindPeriod(_InIt first, _InIt last, size_t minLag, size_t maxLag) noexcept
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		constexpr _Ty zero = static_cast<_Ty>(0);
+
+		PitchPeriod<_Ty> result{ 0.0, zero };
+
+		if (!*this || static_cast<size_t>(std::distance(first, last)) != m_windowSize)
+		{
+			return result;
+		}
+
+		// Last lag needs one more NSDF value for the interpolation
+		maxLag = std::min(maxLag, m_windowSize - 2U);
+		minLag = std::max(minLag, size_t{ 1U });
+
+		if (minLag > maxLag)
+		{
+			return result;
+		}
+
+		// Autocorrelation r(tau) * fftSize as the inverse transform of the power spectrum,
+		// second half of the input stays zero
+		std::copy(first, last, m_signal.begin());
+		m_forwardPlan.Execute();
+
+		std::transform(m_spectrum.begin(), m_spectrum.end(), m_spectrum.begin(), [](const complex_t& bin) {
+			return complex_t{ std::norm(bin), static_cast<_Ty>(0) };
+		});
+
+		m_inversePlan.Execute();
+
+		// NSDF n(tau) = 2 * r(tau) / m(tau), where m(tau) is the sum of squares of both overlapping
+		// parts of the window, updated incrementally as the overlap shrinks
+		const _Ty* signal	= m_signal.data();
+		_Ty* nsdf			= m_nsdf.data();
+		const _Ty scale		= static_cast<_Ty>(2) / static_cast<_Ty>(m_signal.size());
+
+		_Ty energy = static_cast<_Ty>(2) * std::inner_product(signal, signal + m_windowSize, signal, zero);
+
+		if (!(energy > zero))
+		{
+			return result;
+		}
+
+		nsdf[0] = static_cast<_Ty>(1);
+
+		for (size_t lag = 1U; lag <= maxLag + 1U; lag++)
+		{
+			energy -= signal[lag - 1U] * signal[lag - 1U] + signal[m_windowSize - lag] * signal[m_windowSize - lag];
+			nsdf[lag] = energy > zero ? scale * nsdf[lag] / energy : zero;
+		}
+
+		// Skip the lobe around zero lag, then take the highest value between each positive-going
+		// zero crossing and the following negative-going one
+		size_t lag = 1U;
+
+		while (lag <= maxLag && nsdf[lag] > zero)
+		{
+			lag++;
+		}
+
+		m_keyMaxima.clear();
+		_Ty highestMaximum = zero;
+
+		while (lag <= maxLag)
+		{
+			while (lag <= maxLag && nsdf[lag] <= zero)
+			{
+				lag++;
+			}
+
+			size_t keyMaximum = 0U;
+
+			while (lag <= maxLag && nsdf[lag] > zero)
+			{
+				if (lag >= minLag && (keyMaximum == 0U || nsdf[lag] > nsdf[keyMaximum]))
+				{
+					keyMaximum = lag;
+				}
+
+				lag++;
+			}
+
+			if (keyMaximum != 0U)
+			{
+				m_keyMaxima.push_back(keyMaximum);
+				highestMaximum = std::max(highestMaximum, nsdf[keyMaximum]);
+			}
+		}
+
+		if (m_keyMaxima.empty())
+		{
+			return result;
+		}
+
+		// Shortest period close enough to the best one avoids picking its multiples
+		const _Ty minimumHeight	= m_threshold * highestMaximum;
+		const size_t period		= *std::find_if(m_keyMaxima.begin(), m_keyMaxima.end(), [nsdf, minimumHeight](size_t keyMaximum) {
+			return nsdf[keyMaximum] >= minimumHeight;
+		});
+
+		const _Ty left		= nsdf[period - 1U];
+		const _Ty center	= nsdf[period];
+		const _Ty right		= nsdf[period + 1U];
+		const _Ty offset	= ParabolicPeakOffset(left, center, right);
+
+		result.period	= static_cast<double>(period) + static_cast<double>(offset);
+		result.clarity	= center - static_cast<_Ty>(0.25) * (left - right) * offset;
+
+		return result;
+	}
+}
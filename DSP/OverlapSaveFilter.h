@@ -0,0 +1,232 @@
+#pragma once
+#include <algorithm>
+#include <complex>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "DSPTypeTraits.h"
+#include "FFTPlan.h"
+#include "SIMDKernels.h"
+
+namespace DSP
+{
+	// Streaming FIR filter computing the linear convolution of an unbounded signal block by block, with
+	// uniformly partitioned overlap-save. The impulse response is split into partitions of the block size
+	// and the spectra of the last input blocks are kept in a frequency-domain delay line, each block costs
+	// one forward and one inverse FFT of twice the block size plus a multiply-add of the spectra per
+	// partition. Output is not delayed, the latency is one block whatever the length of the filter.
+	template<typename _Ty>
+	class OverlapSaveFilter
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		using complex_t = std::complex<_Ty>;
+
+		// Spectra are stored at a stride of that many bytes, so all of them have the alignment of the
+		// ones the forward plan was created for
+		static constexpr size_t s_spectrumAlignment{ 64U };
+
+		// Previous and current input block
+		std::vector<_Ty>		m_input;
+		// Spectra of the filter partitions followed by the delay line of input spectra
+		std::vector<complex_t>	m_spectra;
+		// Sum of the products of the spectra, overwritten by the inverse FFT
+		std::vector<complex_t>	m_accumulator;
+		std::vector<_Ty>		m_output;
+
+		FFTPlan<_Ty>			m_forwardPlan;
+		FFTPlan<_Ty>			m_inversePlan;
+
+		size_t					m_blockSize;
+		size_t					m_filterSize;
+		size_t					m_partitionCount;
+		size_t					m_spectrumStride;
+		// Position of the spectrum of the current block in the delay line, older ones follow it circularly
+		size_t					m_newestSpectrum;
+
+		complex_t* GetFilterSpectrum(size_t partition) noexcept;
+		complex_t* GetInputSpectrum(size_t position) noexcept;
+
+	public:
+
+		// Empty filter, has to be replaced by a constructed one before use
+		OverlapSaveFilter() noexcept;
+
+		// Filter with the impulse response [first, last), processing blocks of blockSize samples. FFT plans are
+		// created with the given flags, the filter evaluates to false if flags::wisdom was passed and no wisdom
+		// was found.
+		template<typename _InIt>
+		OverlapSaveFilter(_InIt first, _InIt last, size_t blockSize, flags _flags = flags::measure);
+
+		OverlapSaveFilter(OverlapSaveFilter&&)				= default;
+		OverlapSaveFilter& operator=(OverlapSaveFilter&&)	= default;
+
+		OverlapSaveFilter(const OverlapSaveFilter&)				= delete;
+		OverlapSaveFilter& operator=(const OverlapSaveFilter&)	= delete;
+
+		// Check if FFT plans were created
+		explicit operator bool() const noexcept;
+
+		// Get number of samples filtered at once
+		size_t GetBlockSize() const noexcept;
+
+		// Get number of taps of the filter
+		size_t GetFilterSize() const noexcept;
+
+		// Get number of partitions the impulse response is split into
+		size_t GetPartitionCount() const noexcept;
+
+		// Clear the input history, the stream starts over from silence
+		void Reset() noexcept;
+
+		// Filter the next block of the stream, [first, last) must hold exactly GetBlockSize() samples.
+		// Writes as many samples to dest, which may be first.
+		template<typename _InIt, typename _OutIt>
+		void Process(_InIt first, _InIt last, _OutIt dest) noexcept;
+	};
+
+	template<typename _Ty>
+	inline OverlapSaveFilter<_Ty>::OverlapSaveFilter() noexcept :
+		m_blockSize			{ 0U },
+		m_filterSize		{ 0U },
+		m_partitionCount	{ 0U },
+		m_spectrumStride	{ 0U },
+		m_newestSpectrum	{ 0U }
+	{
+	}
+
+	template<typename _Ty>
+	template<typename _InIt>
+	inline OverlapSaveFilter<_Ty>::OverlapSaveFilter(_InIt first, _InIt last, size_t blockSize, flags _flags) :
+		OverlapSaveFilter()
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		const std::vector<_Ty> impulseResponse(first, last);
+
+		if (impulseResponse.empty())
+		{
+			throw std::invalid_argument("Impulse response must not be empty.");
+		}
+
+		if (blockSize == 0U)
+		{
+			throw std::invalid_argument("Block size must be positive.");
+		}
+
+		constexpr size_t stepsPerAlignment = std::max(s_spectrumAlignment / sizeof(complex_t), size_t{ 1U });
+
+		m_blockSize			= blockSize;
+		m_filterSize		= impulseResponse.size();
+		m_partitionCount	= (m_filterSize + blockSize - 1U) / blockSize;
+		// Real FFT of 2 * blockSize samples has blockSize + 1 bins
+		m_spectrumStride	= (blockSize + stepsPerAlignment) / stepsPerAlignment * stepsPerAlignment;
+
+		m_input.resize(2U * blockSize);
+		m_spectra.resize(2U * m_partitionCount * m_spectrumStride);
+		m_accumulator.resize(blockSize + 1U);
+		m_output.resize(2U * blockSize);
+
+		m_forwardPlan = FFTPlan<_Ty>(m_input.begin(), m_input.end(), GetInputSpectrum(0U), _flags);
+		m_inversePlan = FFTPlan<_Ty>(m_accumulator.begin(), m_accumulator.end(), m_output.begin(), _flags);
+
+		if (!*this)
+		{
+			return;
+		}
+
+		// Partitions are zero-padded to the FFT size, so the circular convolution of each one with two
+		// blocks of input is linear over the second block. Inverse FFT is not normalized, its scale is
+		// applied to the filter once.
+		const _Ty scale = static_cast<_Ty>(1) / static_cast<_Ty>(m_input.size());
+
+		for (size_t partition = 0U; partition < m_partitionCount; partition++)
+		{
+			const auto partitionFirst	= impulseResponse.begin() + partition * blockSize;
+			const auto partitionLast	= impulseResponse.begin() + std::min((partition + 1U) * blockSize, m_filterSize);
+
+			std::fill(m_input.begin(), m_input.end(), static_cast<_Ty>(0));
+			std::transform(partitionFirst, partitionLast, m_input.begin(), [scale](_Ty coefficient) {
+				return scale * coefficient;
+			});
+
+			m_forwardPlan.Execute(m_input.begin(), GetFilterSpectrum(partition));
+		}
+
+		// Measuring the plans overwrites the arrays
+		Reset();
+	}
+
+	template<typename _Ty>
+	inline OverlapSaveFilter<_Ty>::operator bool() const noexcept
+	{
+		return m_forwardPlan && m_inversePlan;
+	}
+
+	template<typename _Ty>
+	inline size_t OverlapSaveFilter<_Ty>::GetBlockSize() const noexcept
+	{
+		return m_blockSize;
+	}
+
+	template<typename _Ty>
+	inline size_t OverlapSaveFilter<_Ty>::GetFilterSize() const noexcept
+	{
+		return m_filterSize;
+	}
+
+	template<typename _Ty>
+	inline size_t OverlapSaveFilter<_Ty>::GetPartitionCount() const noexcept
+	{
+		return m_partitionCount;
+	}
+
+	template<typename _Ty>
+	inline void OverlapSaveFilter<_Ty>::Reset() noexcept
+	{
+		std::fill(m_input.begin(), m_input.end(), static_cast<_Ty>(0));
+		std::fill(m_spectra.begin() + m_partitionCount * m_spectrumStride, m_spectra.end(), complex_t(0));
+		m_newestSpectrum = 0U;
+	}
+
+	template<typename _Ty>
+	inline typename OverlapSaveFilter<_Ty>::complex_t* OverlapSaveFilter<_Ty>::GetFilterSpectrum(size_t partition) noexcept
+	{
+		return m_spectra.data() + partition * m_spectrumStride;
+	}
+
+	template<typename _Ty>
+	inline typename OverlapSaveFilter<_Ty>::complex_t* OverlapSaveFilter<_Ty>::GetInputSpectrum(size_t position) noexcept
+	{
+		return m_spectra.data() + (m_partitionCount + position) * m_spectrumStride;
+	}
+
+	template<typename _Ty>
+	template<typename _InIt, typename _OutIt>
+	inline void OverlapSaveFilter<_Ty>::Process(_InIt first, _InIt last, _OutIt dest) noexcept
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		// Current block becomes the previous one
+		std::copy(m_input.begin() + m_blockSize, m_input.end(), m_input.begin());
+		std::copy(first, last, m_input.begin() + m_blockSize);
+
+		// Spectrum of the new input replaces the oldest one in the delay line
+		m_newestSpectrum = (m_newestSpectrum + m_partitionCount - 1U) % m_partitionCount;
+		m_forwardPlan.Execute(m_input.begin(), GetInputSpectrum(m_newestSpectrum));
+
+		// Partition p is applied to the input p blocks back
+		std::fill(m_accumulator.begin(), m_accumulator.end(), complex_t(0));
+
+		for (size_t partition = 0U; partition < m_partitionCount; partition++)
+		{
+			const size_t position = (m_newestSpectrum + partition) % m_partitionCount;
+			SIMD::MultiplyAccumulate(GetInputSpectrum(position), GetFilterSpectrum(partition), m_accumulator.data(), m_accumulator.size());
+		}
+
+		m_inversePlan.Execute();
+
+		// First half is aliased by the circular convolution, the second one is the output of the current block
+		std::copy(m_output.begin() + m_blockSize, m_output.end(), dest);
+	}
+}
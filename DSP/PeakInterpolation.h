@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include "DSPMath.h"
+
+namespace DSP
+{
+	// Offset of the true peak position from the center bin, found by fitting a parabola
+	// through three neighbouring values. Returns a value in range [-0.5, 0.5], 0 if center
+	// is not a local maximum.
+	template<typename _Ty>
+	inline _Ty ParabolicPeakOffset(_Ty left, _Ty center, _Ty right) noexcept
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		const _Ty curvature = left - static_cast<_Ty>(2) * center + right;
+
+		if (!(curvature < static_cast<_Ty>(0)))
+		{
+			return static_cast<_Ty>(0);
+		}
+
+		const _Ty offset = static_cast<_Ty>(0.5) * (left - right) / curvature;
+		return std::clamp(offset, static_cast<_Ty>(-0.5), static_cast<_Ty>(0.5));
+	}
+
+	// Gaussian interpolation, i.e. parabolic interpolation of logarithmic magnitudes. Exact for
+	// Gaussian windows and close to exact for other smooth windows. Takes logarithms of the
+	// magnitudes or squared magnitudes of three neighbouring bins.
+	template<typename _Ty>
+	inline _Ty GaussianPeakOffset(_Ty logLeft, _Ty logCenter, _Ty logRight) noexcept
+	{
+		return ParabolicPeakOffset(logLeft, logCenter, logRight);
+	}
+
+	// Wrap phase to range [-pi, pi)
+	template<typename _Ty>
+	inline _Ty WrapPhase(_Ty phase) noexcept
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		constexpr _Ty twoPi = static_cast<_Ty>(2) * pi<_Ty>;
+		return phase - twoPi * std::floor((phase + pi<_Ty>) / twoPi);
+	}
+
+	// Phase vocoder frequency estimate, in bins, of a sinusoid found in bin of two transforms
+	// of fftSize samples computed hopSize samples apart. Phase advance of the bin is compared
+	// with the advance expected for its center frequency, the difference gives the offset of
+	// the sinusoid from the bin center. Unambiguous for offsets below fftSize / (2 * hopSize) bins.
+	inline double PhaseVocoderFrequency(double previousPhase, double currentPhase, size_t bin, size_t hopSize, size_t fftSize) noexcept
+	{
+		const double binsPerRadian		= static_cast<double>(fftSize) / (2.0 * pi<double> * static_cast<double>(hopSize));
+		const double expectedAdvance	= static_cast<double>(bin) / binsPerRadian;
+		const double deviation			= WrapPhase(currentPhase - previousPhase - expectedAdvance);
+
+		return static_cast<double>(bin) + deviation * binsPerRadian;
+	}
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "DSPTypeTraits.h"
+#include "FilterGenerator.h"
+
+namespace DSP
+{
+	// FIR decimator in polyphase form. The input is low-pass filtered and only every factor-th filtered
+	// sample is computed: coefficients are split into factor phases, each applied to its own subsequence
+	// of the input, so an output costs filterSize multiply-adds accumulated over contiguous arrays.
+	// Blocks are decimated independently, samples outside of a block are taken as zero. Filter delay
+	// is compensated, output k lines up with input k * factor.
+	template<typename _Ty>
+	class PolyphaseDecimator
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		// Phases of the filter, m_phaseLength coefficients each, in reversed order
+		std::vector<_Ty>	m_phases;
+		// Subsequences of the input the phases are applied to, zero-padded in front by m_phaseLength - 1 samples
+		std::vector<_Ty>	m_streams;
+		std::vector<_Ty>	m_output;
+
+		size_t				m_factor;
+		size_t				m_phaseLength;
+		size_t				m_streamLength;
+		size_t				m_inputLength;
+		size_t				m_delay;
+
+	public:
+
+		// Taps of each phase when the filter size is not given
+		static constexpr size_t s_defaultPhaseLength{ 16U };
+
+		// Empty decimator, has to be replaced by a constructed one before use
+		PolyphaseDecimator() noexcept;
+
+		// Decimator of blocks of inputLength samples, a multiple of factor. Low-pass filter of filterSize taps,
+		// factor * s_defaultPhaseLength if 0, has its cutoff at the Nyquist frequency of the output and unit gain.
+		// With the default size and window the band up to a quarter of the output sampling frequency is passed
+		// without aliasing.
+		PolyphaseDecimator(size_t factor, size_t inputLength, size_t filterSize = 0U, WindowGenerator::WindowType windowType = WindowGenerator::WindowType::BlackmanHarris);
+
+		// Check if the decimator was constructed
+		explicit operator bool() const noexcept;
+
+		size_t GetFactor() const noexcept;
+
+		// Get number of samples decimated at once
+		size_t GetInputLength() const noexcept;
+
+		// Get number of samples written by Decimate()
+		size_t GetOutputLength() const noexcept;
+
+		// Decimate [first, last), which must hold exactly GetInputLength() samples, writing GetOutputLength() samples to dest
+		template<typename _InIt, typename _OutIt>
+		void Decimate(_InIt first, _InIt last, _OutIt dest) noexcept;
+	};
+
+	template<typename _Ty>
+	inline PolyphaseDecimator<_Ty>::PolyphaseDecimator() noexcept :
+		m_factor		{ 0U },
+		m_phaseLength	{ 0U },
+		m_streamLength	{ 0U },
+		m_inputLength	{ 0U },
+		m_delay			{ 0U }
+	{
+	}
+
+	template<typename _Ty>
+	inline PolyphaseDecimator<_Ty>::PolyphaseDecimator(size_t factor, size_t inputLength, size_t filterSize, WindowGenerator::WindowType windowType) :
+		PolyphaseDecimator()
+	{
+		if (factor == 0U)
+		{
+			throw std::invalid_argument("Decimation factor must be positive.");
+		}
+
+		if (inputLength == 0U || inputLength % factor != 0U)
+		{
+			throw std::invalid_argument("Input length must be a positive multiple of the decimation factor.");
+		}
+
+		if (filterSize == 0U)
+		{
+			filterSize = factor * s_defaultPhaseLength;
+		}
+
+		std::vector<_Ty> filter(filterSize);
+		GenerateLowPassFIR(static_cast<_Ty>(0.5) / static_cast<_Ty>(factor), static_cast<_Ty>(1), filter.begin(), filter.end(), windowType);
+
+		// Unit gain at DC, the window lowers it slightly
+		const _Ty gain = std::accumulate(filter.begin(), filter.end(), static_cast<_Ty>(0));
+		std::transform(filter.begin(), filter.end(), filter.begin(), [gain](_Ty coefficient) {
+			return coefficient / gain;
+		});
+
+		m_factor		= factor;
+		m_inputLength	= inputLength;
+		m_phaseLength	= (filterSize + factor - 1U) / factor;
+		m_streamLength	= GetOutputLength() + m_phaseLength - 1U;
+		// GenerateLowPassFIR centers the filter at filterSize / 2
+		m_delay			= filterSize / 2U;
+
+		// Coefficient i * factor + p is tap i of phase p, phases shorter than m_phaseLength are zero-padded
+		m_phases.assign(factor * m_phaseLength, static_cast<_Ty>(0));
+
+		for (size_t coefficient = 0U; coefficient < filterSize; coefficient++)
+		{
+			const size_t phase	= coefficient % factor;
+			const size_t tap	= coefficient / factor;
+
+			m_phases[phase * m_phaseLength + m_phaseLength - 1U - tap] = filter[coefficient];
+		}
+
+		m_streams.resize(factor * m_streamLength);
+		m_output.resize(GetOutputLength());
+	}
+
+	template<typename _Ty>
+	inline PolyphaseDecimator<_Ty>::operator bool() const noexcept
+	{
+		return m_factor > 0U;
+	}
+
+	template<typename _Ty>
+	inline size_t PolyphaseDecimator<_Ty>::GetFactor() const noexcept
+	{
+		return m_factor;
+	}
+
+	template<typename _Ty>
+	inline size_t PolyphaseDecimator<_Ty>::GetInputLength() const noexcept
+	{
+		return m_inputLength;
+	}
+
+	template<typename _Ty>
+	inline size_t PolyphaseDecimator<_Ty>::GetOutputLength() const noexcept
+	{
+		return m_factor > 0U ? m_inputLength / m_factor : 0U;
+	}
+
+	template<typename _Ty>
+	template<typename _InIt, typename _OutIt>
+	inline void PolyphaseDecimator<_Ty>::Decimate(_InIt first, _InIt last, _OutIt dest) noexcept
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		using diff_t = std::ptrdiff_t;
+
+		// Output k = sum over phases p and taps i of h[i * factor + p] * x[(k - i) * factor + delay - p].
+		// Sample x[n] belongs to the stream of phase p = (delay - n) mod factor, at position
+		// (n + p - delay) / factor + phaseLength - 1, both tracked incrementally.
+		std::fill(m_streams.begin(), m_streams.end(), static_cast<_Ty>(0));
+
+		const diff_t streamLength	= static_cast<diff_t>(m_streamLength);
+		size_t phase				= m_delay % m_factor;
+		diff_t position				= static_cast<diff_t>(m_phaseLength) - 1 - static_cast<diff_t>((m_delay - phase) / m_factor);
+
+		for (; first != last; ++first)
+		{
+			if (position >= 0 && position < streamLength)
+			{
+				m_streams[phase * m_streamLength + static_cast<size_t>(position)] = *first;
+			}
+
+			if (phase == 0U)
+			{
+				phase = m_factor;
+				position++;
+			}
+
+			phase--;
+		}
+
+		// Each tap of each phase scales a contiguous slice of its stream, the loops vectorize
+		// without reordering any sum
+		const size_t outputLength = GetOutputLength();
+		_Ty* output = m_output.data();
+
+		std::fill(m_output.begin(), m_output.end(), static_cast<_Ty>(0));
+
+		for (size_t p = 0U; p < m_factor; p++)
+		{
+			const _Ty* coefficients	= m_phases.data() + p * m_phaseLength;
+			const _Ty* stream		= m_streams.data() + p * m_streamLength;
+
+			for (size_t tap = 0U; tap < m_phaseLength; tap++)
+			{
+				const _Ty coefficient	= coefficients[tap];
+				const _Ty* input		= stream + tap;
+
+				for (size_t k = 0U; k < outputLength; k++)
+				{
+					output[k] += coefficient * input[k];
+				}
+			}
+		}
+
+		std::copy(m_output.begin(), m_output.end(), dest);
+	}
+}
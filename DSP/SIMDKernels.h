@@ -0,0 +1,1026 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DSP_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#elif defined(_M_ARM) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define DSP_SIMD_NEON
+#if defined(_M_ARM64)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+// MSVC accepts any intrinsic regardless of the compiler flags,
+// GCC and Clang need the instruction set enabled per function
+#if defined(DSP_SIMD_X86) && !defined(_MSC_VER)
+#define DSP_TARGET_SSE3 __attribute__((target("sse3")))
+#define DSP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define DSP_TARGET_SSE3
+#define DSP_TARGET_AVX2
+#endif
+
+// Vectorized pointwise products of contiguous arrays and Goertzel filter banks. The instruction set is detected
+// once at runtime, so the binary runs on any CPU of the target architecture.
+namespace DSP::SIMD
+{
+	enum class InstructionSet
+	{
+		scalar,
+		sse3,
+		avx2,
+		neon
+	};
+
+	// Detect the widest instruction set supported by both the CPU and the OS
+	inline InstructionSet DetectInstructionSet() noexcept
+	{
+#if defined(DSP_SIMD_X86)
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		const bool sse3		= (info[2] & (1 << 0)) != 0;
+		const bool fma		= (info[2] & (1 << 12)) != 0;
+		const bool osxsave	= (info[2] & (1 << 27)) != 0;
+		const bool avx		= (info[2] & (1 << 28)) != 0;
+		bool avx2			= false;
+
+		if (maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+
+		// OS must save the YMM registers on context switch
+		const bool ymmEnabled = osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+
+		if (avx2 && fma && ymmEnabled)
+		{
+			return InstructionSet::avx2;
+		}
+#else
+		__builtin_cpu_init();
+		const bool sse3 = __builtin_cpu_supports("sse3");
+
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		{
+			return InstructionSet::avx2;
+		}
+#endif
+		return sse3 ? InstructionSet::sse3 : InstructionSet::scalar;
+#elif defined(DSP_SIMD_NEON)
+		return InstructionSet::neon;
+#else
+		return InstructionSet::scalar;
+#endif
+	}
+
+	// Get the instruction set used by the kernels
+	inline InstructionSet GetInstructionSet() noexcept
+	{
+		static const InstructionSet instructionSet = DetectInstructionSet();
+		return instructionSet;
+	}
+
+	namespace Detail
+	{
+		template<typename _Ty>
+		inline void MultiplyScalar(const _Ty* first1, const _Ty* first2, _Ty* dest, size_t count) noexcept
+		{
+			for (size_t i = 0U; i < count; i++)
+			{
+				dest[i] = first1[i] * first2[i];
+			}
+		}
+
+		// Plain formula, std::complex multiplication may call a slow, NaN-aware library function
+		template<typename _Ty>
+		inline void MultiplyScalar(const std::complex<_Ty>* first1, const std::complex<_Ty>* first2, std::complex<_Ty>* dest, size_t count) noexcept
+		{
+			const _Ty* a	= reinterpret_cast<const _Ty*>(first1);
+			const _Ty* b	= reinterpret_cast<const _Ty*>(first2);
+			_Ty* out		= reinterpret_cast<_Ty*>(dest);
+
+			for (size_t i = 0U; i < 2U * count; i += 2U)
+			{
+				const _Ty re = a[i] * b[i] - a[i + 1U] * b[i + 1U];
+				const _Ty im = a[i] * b[i + 1U] + a[i + 1U] * b[i];
+				out[i]		= re;
+				out[i + 1U]	= im;
+			}
+		}
+
+#if defined(DSP_SIMD_X86)
+		DSP_TARGET_AVX2 inline void MultiplyAVX2(const float* first1, const float* first2, float* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 8U <= count; i += 8U)
+			{
+				_mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(first1 + i), _mm256_loadu_ps(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_AVX2 inline void MultiplyAVX2(const double* first1, const double* first2, double* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				_mm256_storeu_pd(dest + i, _mm256_mul_pd(_mm256_loadu_pd(first1 + i), _mm256_loadu_pd(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		// (a + bi)(c + di) = (ac - bd) + (bc + ad)i, computed as fmaddsub([a, b] * [c, c], [b, a] * [d, d])
+		DSP_TARGET_AVX2 inline void MultiplyAVX2(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* dest, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* out		= reinterpret_cast<float*>(dest);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const __m256 x		= _mm256_loadu_ps(a + 2U * i);
+				const __m256 y		= _mm256_loadu_ps(b + 2U * i);
+				const __m256 yRe	= _mm256_moveldup_ps(y);
+				const __m256 yIm	= _mm256_movehdup_ps(y);
+				const __m256 xSwap	= _mm256_permute_ps(x, 0xB1);
+
+				_mm256_storeu_ps(out + 2U * i, _mm256_fmaddsub_ps(x, yRe, _mm256_mul_ps(xSwap, yIm)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_AVX2 inline void MultiplyAVX2(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* dest, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* out		= reinterpret_cast<double*>(dest);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const __m256d x		= _mm256_loadu_pd(a + 2U * i);
+				const __m256d y		= _mm256_loadu_pd(b + 2U * i);
+				const __m256d yRe	= _mm256_movedup_pd(y);
+				const __m256d yIm	= _mm256_permute_pd(y, 0xF);
+				const __m256d xSwap	= _mm256_permute_pd(x, 0x5);
+
+				_mm256_storeu_pd(out + 2U * i, _mm256_fmaddsub_pd(x, yRe, _mm256_mul_pd(xSwap, yIm)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void MultiplySSE3(const float* first1, const float* first2, float* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				_mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(first1 + i), _mm_loadu_ps(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void MultiplySSE3(const double* first1, const double* first2, double* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				_mm_storeu_pd(dest + i, _mm_mul_pd(_mm_loadu_pd(first1 + i), _mm_loadu_pd(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void MultiplySSE3(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* dest, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* out		= reinterpret_cast<float*>(dest);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const __m128 x		= _mm_loadu_ps(a + 2U * i);
+				const __m128 y		= _mm_loadu_ps(b + 2U * i);
+				const __m128 yRe	= _mm_moveldup_ps(y);
+				const __m128 yIm	= _mm_movehdup_ps(y);
+				const __m128 xSwap	= _mm_shuffle_ps(x, x, 0xB1);
+
+				_mm_storeu_ps(out + 2U * i, _mm_addsub_ps(_mm_mul_ps(x, yRe), _mm_mul_ps(xSwap, yIm)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void MultiplySSE3(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* dest, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* out		= reinterpret_cast<double*>(dest);
+
+			for (size_t i = 0U; i < count; i++)
+			{
+				const __m128d x		= _mm_loadu_pd(a + 2U * i);
+				const __m128d y		= _mm_loadu_pd(b + 2U * i);
+				const __m128d yRe	= _mm_movedup_pd(y);
+				const __m128d yIm	= _mm_unpackhi_pd(y, y);
+				const __m128d xSwap	= _mm_shuffle_pd(x, x, 0x1);
+
+				_mm_storeu_pd(out + 2U * i, _mm_addsub_pd(_mm_mul_pd(x, yRe), _mm_mul_pd(xSwap, yIm)));
+			}
+		}
+#elif defined(DSP_SIMD_NEON)
+		inline void MultiplyNEON(const float* first1, const float* first2, float* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				vst1q_f32(dest + i, vmulq_f32(vld1q_f32(first1 + i), vld1q_f32(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		// Deinterleaving loads split the real and imaginary parts into separate registers
+		inline void MultiplyNEON(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* dest, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* out		= reinterpret_cast<float*>(dest);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const float32x4x2_t x = vld2q_f32(a + 2U * i);
+				const float32x4x2_t y = vld2q_f32(b + 2U * i);
+				float32x4x2_t result;
+
+				result.val[0] = vmlsq_f32(vmulq_f32(x.val[0], y.val[0]), x.val[1], y.val[1]);
+				result.val[1] = vmlaq_f32(vmulq_f32(x.val[0], y.val[1]), x.val[1], y.val[0]);
+				vst2q_f32(out + 2U * i, result);
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		inline void MultiplyNEON(const double* first1, const double* first2, double* dest, size_t count) noexcept
+		{
+			size_t i = 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				vst1q_f64(dest + i, vmulq_f64(vld1q_f64(first1 + i), vld1q_f64(first2 + i)));
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+
+		inline void MultiplyNEON(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* dest, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* out		= reinterpret_cast<double*>(dest);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const float64x2x2_t x = vld2q_f64(a + 2U * i);
+				const float64x2x2_t y = vld2q_f64(b + 2U * i);
+				float64x2x2_t result;
+
+				result.val[0] = vfmsq_f64(vmulq_f64(x.val[0], y.val[0]), x.val[1], y.val[1]);
+				result.val[1] = vfmaq_f64(vmulq_f64(x.val[0], y.val[1]), x.val[1], y.val[0]);
+				vst2q_f64(out + 2U * i, result);
+			}
+
+			MultiplyScalar(first1 + i, first2 + i, dest + i, count - i);
+		}
+#else
+		// ARMv7 NEON has no double precision arithmetic
+		template<typename _Ty>
+		inline void MultiplyNEON(const _Ty* first1, const _Ty* first2, _Ty* dest, size_t count) noexcept
+		{
+			MultiplyScalar(first1, first2, dest, count);
+		}
+#endif
+#endif
+	}
+
+	namespace Detail
+	{
+		// With s_broadcast, first2 points to a single factor
+		template<bool s_broadcast, typename _Ty>
+		inline void MultiplyAccumulateScalar(const std::complex<_Ty>* first1, const std::complex<_Ty>* first2, std::complex<_Ty>* accumulator, size_t count) noexcept
+		{
+			const _Ty* a	= reinterpret_cast<const _Ty*>(first1);
+			const _Ty* b	= reinterpret_cast<const _Ty*>(first2);
+			_Ty* sum		= reinterpret_cast<_Ty*>(accumulator);
+
+			for (size_t i = 0U; i < 2U * count; i += 2U)
+			{
+				const size_t j = s_broadcast ? 0U : i;
+
+				sum[i]		+= a[i] * b[j] - a[i + 1U] * b[j + 1U];
+				sum[i + 1U]	+= a[i] * b[j + 1U] + a[i + 1U] * b[j];
+			}
+		}
+
+#if defined(DSP_SIMD_X86)
+		template<bool s_broadcast>
+		DSP_TARGET_AVX2 inline void MultiplyAccumulateAVX2(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* accumulator, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* sum		= reinterpret_cast<float*>(accumulator);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const __m256 x		= _mm256_loadu_ps(a + 2U * i);
+				const __m256 y		= s_broadcast ? _mm256_setr_ps(b[0], b[1], b[0], b[1], b[0], b[1], b[0], b[1]) : _mm256_loadu_ps(b + 2U * i);
+				const __m256 yRe	= _mm256_moveldup_ps(y);
+				const __m256 yIm	= _mm256_movehdup_ps(y);
+				const __m256 xSwap	= _mm256_permute_ps(x, 0xB1);
+				const __m256 product	= _mm256_fmaddsub_ps(x, yRe, _mm256_mul_ps(xSwap, yIm));
+
+				_mm256_storeu_ps(sum + 2U * i, _mm256_add_ps(_mm256_loadu_ps(sum + 2U * i), product));
+			}
+
+			MultiplyAccumulateScalar<s_broadcast>(first1 + i, first2 + (s_broadcast ? 0U : i), accumulator + i, count - i);
+		}
+
+		template<bool s_broadcast>
+		DSP_TARGET_AVX2 inline void MultiplyAccumulateAVX2(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* accumulator, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* sum		= reinterpret_cast<double*>(accumulator);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const __m256d x			= _mm256_loadu_pd(a + 2U * i);
+				const __m256d y			= s_broadcast ? _mm256_setr_pd(b[0], b[1], b[0], b[1]) : _mm256_loadu_pd(b + 2U * i);
+				const __m256d yRe		= _mm256_movedup_pd(y);
+				const __m256d yIm		= _mm256_permute_pd(y, 0xF);
+				const __m256d xSwap		= _mm256_permute_pd(x, 0x5);
+				const __m256d product	= _mm256_fmaddsub_pd(x, yRe, _mm256_mul_pd(xSwap, yIm));
+
+				_mm256_storeu_pd(sum + 2U * i, _mm256_add_pd(_mm256_loadu_pd(sum + 2U * i), product));
+			}
+
+			MultiplyAccumulateScalar<s_broadcast>(first1 + i, first2 + (s_broadcast ? 0U : i), accumulator + i, count - i);
+		}
+
+		template<bool s_broadcast>
+		DSP_TARGET_SSE3 inline void MultiplyAccumulateSSE3(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* accumulator, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* sum		= reinterpret_cast<float*>(accumulator);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const __m128 x			= _mm_loadu_ps(a + 2U * i);
+				const __m128 y			= s_broadcast ? _mm_setr_ps(b[0], b[1], b[0], b[1]) : _mm_loadu_ps(b + 2U * i);
+				const __m128 yRe		= _mm_moveldup_ps(y);
+				const __m128 yIm		= _mm_movehdup_ps(y);
+				const __m128 xSwap		= _mm_shuffle_ps(x, x, 0xB1);
+				const __m128 product	= _mm_addsub_ps(_mm_mul_ps(x, yRe), _mm_mul_ps(xSwap, yIm));
+
+				_mm_storeu_ps(sum + 2U * i, _mm_add_ps(_mm_loadu_ps(sum + 2U * i), product));
+			}
+
+			MultiplyAccumulateScalar<s_broadcast>(first1 + i, first2 + (s_broadcast ? 0U : i), accumulator + i, count - i);
+		}
+
+		template<bool s_broadcast>
+		DSP_TARGET_SSE3 inline void MultiplyAccumulateSSE3(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* accumulator, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* sum		= reinterpret_cast<double*>(accumulator);
+
+			for (size_t i = 0U; i < count; i++)
+			{
+				const __m128d x			= _mm_loadu_pd(a + 2U * i);
+				const __m128d y			= s_broadcast ? _mm_setr_pd(b[0], b[1]) : _mm_loadu_pd(b + 2U * i);
+				const __m128d yRe		= _mm_movedup_pd(y);
+				const __m128d yIm		= _mm_unpackhi_pd(y, y);
+				const __m128d xSwap		= _mm_shuffle_pd(x, x, 0x1);
+				const __m128d product	= _mm_addsub_pd(_mm_mul_pd(x, yRe), _mm_mul_pd(xSwap, yIm));
+
+				_mm_storeu_pd(sum + 2U * i, _mm_add_pd(_mm_loadu_pd(sum + 2U * i), product));
+			}
+		}
+#elif defined(DSP_SIMD_NEON)
+		template<bool s_broadcast>
+		inline void MultiplyAccumulateNEON(const std::complex<float>* first1, const std::complex<float>* first2, std::complex<float>* accumulator, size_t count) noexcept
+		{
+			const float* a	= reinterpret_cast<const float*>(first1);
+			const float* b	= reinterpret_cast<const float*>(first2);
+			float* sum		= reinterpret_cast<float*>(accumulator);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const float32x4x2_t x	= vld2q_f32(a + 2U * i);
+				const float32x4x2_t y	= s_broadcast ? float32x4x2_t{ { vdupq_n_f32(b[0]), vdupq_n_f32(b[1]) } } : vld2q_f32(b + 2U * i);
+				float32x4x2_t result	= vld2q_f32(sum + 2U * i);
+
+				result.val[0] = vmlsq_f32(vmlaq_f32(result.val[0], x.val[0], y.val[0]), x.val[1], y.val[1]);
+				result.val[1] = vmlaq_f32(vmlaq_f32(result.val[1], x.val[0], y.val[1]), x.val[1], y.val[0]);
+				vst2q_f32(sum + 2U * i, result);
+			}
+
+			MultiplyAccumulateScalar<s_broadcast>(first1 + i, first2 + (s_broadcast ? 0U : i), accumulator + i, count - i);
+		}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		template<bool s_broadcast>
+		inline void MultiplyAccumulateNEON(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* accumulator, size_t count) noexcept
+		{
+			const double* a	= reinterpret_cast<const double*>(first1);
+			const double* b	= reinterpret_cast<const double*>(first2);
+			double* sum		= reinterpret_cast<double*>(accumulator);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const float64x2x2_t x	= vld2q_f64(a + 2U * i);
+				const float64x2x2_t y	= s_broadcast ? float64x2x2_t{ { vdupq_n_f64(b[0]), vdupq_n_f64(b[1]) } } : vld2q_f64(b + 2U * i);
+				float64x2x2_t result	= vld2q_f64(sum + 2U * i);
+
+				result.val[0] = vfmsq_f64(vfmaq_f64(result.val[0], x.val[0], y.val[0]), x.val[1], y.val[1]);
+				result.val[1] = vfmaq_f64(vfmaq_f64(result.val[1], x.val[0], y.val[1]), x.val[1], y.val[0]);
+				vst2q_f64(sum + 2U * i, result);
+			}
+
+			MultiplyAccumulateScalar<s_broadcast>(first1 + i, first2 + (s_broadcast ? 0U : i), accumulator + i, count - i);
+		}
+#else
+		template<bool s_broadcast>
+		inline void MultiplyAccumulateNEON(const std::complex<double>* first1, const std::complex<double>* first2, std::complex<double>* accumulator, size_t count) noexcept
+		{
+			MultiplyAccumulateScalar<s_broadcast>(first1, first2, accumulator, count);
+		}
+#endif
+#endif
+	}
+
+	namespace Detail
+	{
+		template<typename _Ty>
+		inline void WeightedPowerScalar(const std::complex<_Ty>* spectrum, const _Ty* weights, _Ty* dest, size_t count) noexcept
+		{
+			const _Ty* x = reinterpret_cast<const _Ty*>(spectrum);
+
+			for (size_t i = 0U; i < count; i++)
+			{
+				dest[i] = (x[2U * i] * x[2U * i] + x[2U * i + 1U] * x[2U * i + 1U]) * weights[i];
+			}
+		}
+
+#if defined(DSP_SIMD_X86)
+		// Horizontal adds of squared pairs give the norms, lane crossing order is fixed by a permute
+		DSP_TARGET_AVX2 inline void WeightedPowerAVX2(const std::complex<float>* spectrum, const float* weights, float* dest, size_t count) noexcept
+		{
+			const float* x	= reinterpret_cast<const float*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 8U <= count; i += 8U)
+			{
+				const __m256 a		= _mm256_loadu_ps(x + 2U * i);
+				const __m256 b		= _mm256_loadu_ps(x + 2U * i + 8U);
+				const __m256 norm	= _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+				const __m256 sorted	= _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(norm), 0xD8));
+
+				_mm256_storeu_ps(dest + i, _mm256_mul_ps(sorted, _mm256_loadu_ps(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_AVX2 inline void WeightedPowerAVX2(const std::complex<double>* spectrum, const double* weights, double* dest, size_t count) noexcept
+		{
+			const double* x	= reinterpret_cast<const double*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const __m256d a			= _mm256_loadu_pd(x + 2U * i);
+				const __m256d b			= _mm256_loadu_pd(x + 2U * i + 4U);
+				const __m256d norm		= _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+				const __m256d sorted	= _mm256_permute4x64_pd(norm, 0xD8);
+
+				_mm256_storeu_pd(dest + i, _mm256_mul_pd(sorted, _mm256_loadu_pd(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void WeightedPowerSSE3(const std::complex<float>* spectrum, const float* weights, float* dest, size_t count) noexcept
+		{
+			const float* x	= reinterpret_cast<const float*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const __m128 a		= _mm_loadu_ps(x + 2U * i);
+				const __m128 b		= _mm_loadu_ps(x + 2U * i + 4U);
+				const __m128 norm	= _mm_hadd_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b));
+
+				_mm_storeu_ps(dest + i, _mm_mul_ps(norm, _mm_loadu_ps(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+
+		DSP_TARGET_SSE3 inline void WeightedPowerSSE3(const std::complex<double>* spectrum, const double* weights, double* dest, size_t count) noexcept
+		{
+			const double* x	= reinterpret_cast<const double*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const __m128d a		= _mm_loadu_pd(x + 2U * i);
+				const __m128d b		= _mm_loadu_pd(x + 2U * i + 2U);
+				const __m128d norm	= _mm_hadd_pd(_mm_mul_pd(a, a), _mm_mul_pd(b, b));
+
+				_mm_storeu_pd(dest + i, _mm_mul_pd(norm, _mm_loadu_pd(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+#elif defined(DSP_SIMD_NEON)
+		inline void WeightedPowerNEON(const std::complex<float>* spectrum, const float* weights, float* dest, size_t count) noexcept
+		{
+			const float* x	= reinterpret_cast<const float*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 4U <= count; i += 4U)
+			{
+				const float32x4x2_t bins	= vld2q_f32(x + 2U * i);
+				const float32x4_t norm		= vmlaq_f32(vmulq_f32(bins.val[0], bins.val[0]), bins.val[1], bins.val[1]);
+
+				vst1q_f32(dest + i, vmulq_f32(norm, vld1q_f32(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		inline void WeightedPowerNEON(const std::complex<double>* spectrum, const double* weights, double* dest, size_t count) noexcept
+		{
+			const double* x	= reinterpret_cast<const double*>(spectrum);
+			size_t i		= 0U;
+
+			for (; i + 2U <= count; i += 2U)
+			{
+				const float64x2x2_t bins	= vld2q_f64(x + 2U * i);
+				const float64x2_t norm		= vfmaq_f64(vmulq_f64(bins.val[0], bins.val[0]), bins.val[1], bins.val[1]);
+
+				vst1q_f64(dest + i, vmulq_f64(norm, vld1q_f64(weights + i)));
+			}
+
+			WeightedPowerScalar(spectrum + i, weights + i, dest + i, count - i);
+		}
+#else
+		inline void WeightedPowerNEON(const std::complex<double>* spectrum, const double* weights, double* dest, size_t count) noexcept
+		{
+			WeightedPowerScalar(spectrum, weights, dest, count);
+		}
+#endif
+#endif
+	}
+
+	namespace Detail
+	{
+		// Each filter runs over all samples with its states in registers, the recurrence is serial in n
+		template<typename _Ty>
+		inline void GoertzelScalar(const _Ty* samples, size_t sampleCount, const _Ty* coefficients, _Ty* state1, _Ty* state2, size_t count) noexcept
+		{
+			for (size_t k = 0U; k < count; k++)
+			{
+				const _Ty coefficient	= coefficients[k];
+				_Ty s1					= state1[k];
+				_Ty s2					= state2[k];
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const _Ty s0 = samples[n] + coefficient * s1 - s2;
+					s2 = s1;
+					s1 = s0;
+				}
+
+				state1[k] = s1;
+				state2[k] = s2;
+			}
+		}
+
+#if defined(DSP_SIMD_X86)
+		// Filters are updated a register at a time, two independent registers hide the latency of the recurrence
+		DSP_TARGET_AVX2 inline void GoertzelAVX2(const float* samples, size_t sampleCount, const float* coefficients, float* state1, float* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 16U <= count; k += 16U)
+			{
+				const __m256 c0 = _mm256_loadu_ps(coefficients + k);
+				const __m256 c1 = _mm256_loadu_ps(coefficients + k + 8U);
+				__m256 s10 = _mm256_loadu_ps(state1 + k);
+				__m256 s11 = _mm256_loadu_ps(state1 + k + 8U);
+				__m256 s20 = _mm256_loadu_ps(state2 + k);
+				__m256 s21 = _mm256_loadu_ps(state2 + k + 8U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m256 x	= _mm256_set1_ps(samples[n]);
+					const __m256 s0	= _mm256_fmadd_ps(c0, s10, _mm256_sub_ps(x, s20));
+					const __m256 s1	= _mm256_fmadd_ps(c1, s11, _mm256_sub_ps(x, s21));
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				_mm256_storeu_ps(state1 + k, s10);
+				_mm256_storeu_ps(state1 + k + 8U, s11);
+				_mm256_storeu_ps(state2 + k, s20);
+				_mm256_storeu_ps(state2 + k + 8U, s21);
+			}
+
+			for (; k + 8U <= count; k += 8U)
+			{
+				const __m256 c = _mm256_loadu_ps(coefficients + k);
+				__m256 s1 = _mm256_loadu_ps(state1 + k);
+				__m256 s2 = _mm256_loadu_ps(state2 + k);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m256 s0 = _mm256_fmadd_ps(c, s1, _mm256_sub_ps(_mm256_set1_ps(samples[n]), s2));
+					s2 = s1;
+					s1 = s0;
+				}
+
+				_mm256_storeu_ps(state1 + k, s1);
+				_mm256_storeu_ps(state2 + k, s2);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+
+		DSP_TARGET_AVX2 inline void GoertzelAVX2(const double* samples, size_t sampleCount, const double* coefficients, double* state1, double* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 8U <= count; k += 8U)
+			{
+				const __m256d c0 = _mm256_loadu_pd(coefficients + k);
+				const __m256d c1 = _mm256_loadu_pd(coefficients + k + 4U);
+				__m256d s10 = _mm256_loadu_pd(state1 + k);
+				__m256d s11 = _mm256_loadu_pd(state1 + k + 4U);
+				__m256d s20 = _mm256_loadu_pd(state2 + k);
+				__m256d s21 = _mm256_loadu_pd(state2 + k + 4U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m256d x		= _mm256_set1_pd(samples[n]);
+					const __m256d s0	= _mm256_fmadd_pd(c0, s10, _mm256_sub_pd(x, s20));
+					const __m256d s1	= _mm256_fmadd_pd(c1, s11, _mm256_sub_pd(x, s21));
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				_mm256_storeu_pd(state1 + k, s10);
+				_mm256_storeu_pd(state1 + k + 4U, s11);
+				_mm256_storeu_pd(state2 + k, s20);
+				_mm256_storeu_pd(state2 + k + 4U, s21);
+			}
+
+			for (; k + 4U <= count; k += 4U)
+			{
+				const __m256d c = _mm256_loadu_pd(coefficients + k);
+				__m256d s1 = _mm256_loadu_pd(state1 + k);
+				__m256d s2 = _mm256_loadu_pd(state2 + k);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m256d s0 = _mm256_fmadd_pd(c, s1, _mm256_sub_pd(_mm256_set1_pd(samples[n]), s2));
+					s2 = s1;
+					s1 = s0;
+				}
+
+				_mm256_storeu_pd(state1 + k, s1);
+				_mm256_storeu_pd(state2 + k, s2);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+
+		DSP_TARGET_SSE3 inline void GoertzelSSE3(const float* samples, size_t sampleCount, const float* coefficients, float* state1, float* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 8U <= count; k += 8U)
+			{
+				const __m128 c0 = _mm_loadu_ps(coefficients + k);
+				const __m128 c1 = _mm_loadu_ps(coefficients + k + 4U);
+				__m128 s10 = _mm_loadu_ps(state1 + k);
+				__m128 s11 = _mm_loadu_ps(state1 + k + 4U);
+				__m128 s20 = _mm_loadu_ps(state2 + k);
+				__m128 s21 = _mm_loadu_ps(state2 + k + 4U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m128 x	= _mm_set1_ps(samples[n]);
+					const __m128 s0	= _mm_add_ps(_mm_mul_ps(c0, s10), _mm_sub_ps(x, s20));
+					const __m128 s1	= _mm_add_ps(_mm_mul_ps(c1, s11), _mm_sub_ps(x, s21));
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				_mm_storeu_ps(state1 + k, s10);
+				_mm_storeu_ps(state1 + k + 4U, s11);
+				_mm_storeu_ps(state2 + k, s20);
+				_mm_storeu_ps(state2 + k + 4U, s21);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+
+		DSP_TARGET_SSE3 inline void GoertzelSSE3(const double* samples, size_t sampleCount, const double* coefficients, double* state1, double* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 4U <= count; k += 4U)
+			{
+				const __m128d c0 = _mm_loadu_pd(coefficients + k);
+				const __m128d c1 = _mm_loadu_pd(coefficients + k + 2U);
+				__m128d s10 = _mm_loadu_pd(state1 + k);
+				__m128d s11 = _mm_loadu_pd(state1 + k + 2U);
+				__m128d s20 = _mm_loadu_pd(state2 + k);
+				__m128d s21 = _mm_loadu_pd(state2 + k + 2U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const __m128d x		= _mm_set1_pd(samples[n]);
+					const __m128d s0	= _mm_add_pd(_mm_mul_pd(c0, s10), _mm_sub_pd(x, s20));
+					const __m128d s1	= _mm_add_pd(_mm_mul_pd(c1, s11), _mm_sub_pd(x, s21));
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				_mm_storeu_pd(state1 + k, s10);
+				_mm_storeu_pd(state1 + k + 2U, s11);
+				_mm_storeu_pd(state2 + k, s20);
+				_mm_storeu_pd(state2 + k + 2U, s21);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+#elif defined(DSP_SIMD_NEON)
+		inline void GoertzelNEON(const float* samples, size_t sampleCount, const float* coefficients, float* state1, float* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 8U <= count; k += 8U)
+			{
+				const float32x4_t c0 = vld1q_f32(coefficients + k);
+				const float32x4_t c1 = vld1q_f32(coefficients + k + 4U);
+				float32x4_t s10 = vld1q_f32(state1 + k);
+				float32x4_t s11 = vld1q_f32(state1 + k + 4U);
+				float32x4_t s20 = vld1q_f32(state2 + k);
+				float32x4_t s21 = vld1q_f32(state2 + k + 4U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const float32x4_t x		= vdupq_n_f32(samples[n]);
+					const float32x4_t s0	= vmlaq_f32(vsubq_f32(x, s20), c0, s10);
+					const float32x4_t s1	= vmlaq_f32(vsubq_f32(x, s21), c1, s11);
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				vst1q_f32(state1 + k, s10);
+				vst1q_f32(state1 + k + 4U, s11);
+				vst1q_f32(state2 + k, s20);
+				vst1q_f32(state2 + k + 4U, s21);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+		inline void GoertzelNEON(const double* samples, size_t sampleCount, const double* coefficients, double* state1, double* state2, size_t count) noexcept
+		{
+			size_t k = 0U;
+
+			for (; k + 4U <= count; k += 4U)
+			{
+				const float64x2_t c0 = vld1q_f64(coefficients + k);
+				const float64x2_t c1 = vld1q_f64(coefficients + k + 2U);
+				float64x2_t s10 = vld1q_f64(state1 + k);
+				float64x2_t s11 = vld1q_f64(state1 + k + 2U);
+				float64x2_t s20 = vld1q_f64(state2 + k);
+				float64x2_t s21 = vld1q_f64(state2 + k + 2U);
+
+				for (size_t n = 0U; n < sampleCount; n++)
+				{
+					const float64x2_t x		= vdupq_n_f64(samples[n]);
+					const float64x2_t s0	= vfmaq_f64(vsubq_f64(x, s20), c0, s10);
+					const float64x2_t s1	= vfmaq_f64(vsubq_f64(x, s21), c1, s11);
+					s20 = s10;
+					s21 = s11;
+					s10 = s0;
+					s11 = s1;
+				}
+
+				vst1q_f64(state1 + k, s10);
+				vst1q_f64(state1 + k + 2U, s11);
+				vst1q_f64(state2 + k, s20);
+				vst1q_f64(state2 + k + 2U, s21);
+			}
+
+			GoertzelScalar(samples, sampleCount, coefficients + k, state1 + k, state2 + k, count - k);
+		}
+#else
+		inline void GoertzelNEON(const double* samples, size_t sampleCount, const double* coefficients, double* state1, double* state2, size_t count) noexcept
+		{
+			GoertzelScalar(samples, sampleCount, coefficients, state1, state2, count);
+		}
+#endif
+#endif
+	}
+
+	// Element types the kernels are provided for
+	template<typename _Ty>
+	inline constexpr bool Is_supported_type =
+		std::is_same_v<_Ty, float> || std::is_same_v<_Ty, double> ||
+		std::is_same_v<_Ty, std::complex<float>> || std::is_same_v<_Ty, std::complex<double>>;
+
+	// dest[i] = first1[i] * first2[i] for i in [0, count). dest may be equal to first1 or first2,
+	// but the arrays must not overlap otherwise.
+	template<typename _Ty>
+	inline void MultiplyPointwise(const _Ty* first1, const _Ty* first2, _Ty* dest, size_t count) noexcept
+	{
+		static_assert(Is_supported_type<_Ty>, "SIMD kernels support float, double and their complex types only.");
+
+		switch (GetInstructionSet())
+		{
+#if defined(DSP_SIMD_X86)
+		case InstructionSet::avx2:
+			Detail::MultiplyAVX2(first1, first2, dest, count);
+			break;
+		case InstructionSet::sse3:
+			Detail::MultiplySSE3(first1, first2, dest, count);
+			break;
+#elif defined(DSP_SIMD_NEON)
+		case InstructionSet::neon:
+			Detail::MultiplyNEON(first1, first2, dest, count);
+			break;
+#endif
+		default:
+			Detail::MultiplyScalar(first1, first2, dest, count);
+			break;
+		}
+	}
+
+	namespace Detail
+	{
+		// Types other than complex float and double use the scalar kernel
+		template<bool s_broadcast, typename _Ty>
+		inline void MultiplyAccumulate(const std::complex<_Ty>* first1, const std::complex<_Ty>* first2, std::complex<_Ty>* accumulator, size_t count) noexcept
+		{
+			if constexpr (!Is_supported_type<std::complex<_Ty>>)
+			{
+				MultiplyAccumulateScalar<s_broadcast>(first1, first2, accumulator, count);
+			}
+			else
+			{
+				switch (GetInstructionSet())
+				{
+#if defined(DSP_SIMD_X86)
+				case InstructionSet::avx2:
+					MultiplyAccumulateAVX2<s_broadcast>(first1, first2, accumulator, count);
+					break;
+				case InstructionSet::sse3:
+					MultiplyAccumulateSSE3<s_broadcast>(first1, first2, accumulator, count);
+					break;
+#elif defined(DSP_SIMD_NEON)
+				case InstructionSet::neon:
+					MultiplyAccumulateNEON<s_broadcast>(first1, first2, accumulator, count);
+					break;
+#endif
+				default:
+					MultiplyAccumulateScalar<s_broadcast>(first1, first2, accumulator, count);
+					break;
+				}
+			}
+		}
+	}
+
+	// accumulator[i] += first1[i] * first2[i] for i in [0, count), the arrays must not overlap. Complex products
+	// are written out in all kernels, std::complex multiplication checks for infinities in a library call which
+	// keeps the loop from being vectorized.
+	template<typename _Ty>
+	inline void MultiplyAccumulate(const std::complex<_Ty>* first1, const std::complex<_Ty>* first2, std::complex<_Ty>* accumulator, size_t count) noexcept
+	{
+		Detail::MultiplyAccumulate<false>(first1, first2, accumulator, count);
+	}
+
+	// accumulator[i] += first[i] * factor for i in [0, count)
+	template<typename _Ty>
+	inline void MultiplyAccumulate(const std::complex<_Ty>* first, std::complex<_Ty> factor, std::complex<_Ty>* accumulator, size_t count) noexcept
+	{
+		Detail::MultiplyAccumulate<true>(first, &factor, accumulator, count);
+	}
+
+	// dest[i] = |spectrum[i]|^2 * weights[i] for i in [0, count). Squared magnitude of a filtered
+	// spectrum equals the squared magnitude of the input times the squared filter magnitude.
+	template<typename _Ty>
+	inline void WeightedPower(const std::complex<_Ty>* spectrum, const _Ty* weights, _Ty* dest, size_t count) noexcept
+	{
+		static_assert(std::is_same_v<_Ty, float> || std::is_same_v<_Ty, double>, "SIMD kernels support float and double only.");
+
+		switch (GetInstructionSet())
+		{
+#if defined(DSP_SIMD_X86)
+		case InstructionSet::avx2:
+			Detail::WeightedPowerAVX2(spectrum, weights, dest, count);
+			break;
+		case InstructionSet::sse3:
+			Detail::WeightedPowerSSE3(spectrum, weights, dest, count);
+			break;
+#elif defined(DSP_SIMD_NEON)
+		case InstructionSet::neon:
+			Detail::WeightedPowerNEON(spectrum, weights, dest, count);
+			break;
+#endif
+		default:
+			Detail::WeightedPowerScalar(spectrum, weights, dest, count);
+			break;
+		}
+	}
+
+	// Run count Goertzel filters over the same samples, s[n] = x[n] + coefficients[k] * s[n - 1] - s[n - 2]
+	// for filter k. state1[k] and state2[k] hold s[n - 1] and s[n - 2], they are read and updated,
+	// so a signal may be passed in consecutive blocks.
+	template<typename _Ty>
+	inline void GoertzelRecurrence(const _Ty* samples, size_t sampleCount, const _Ty* coefficients, _Ty* state1, _Ty* state2, size_t count) noexcept
+	{
+		static_assert(std::is_same_v<_Ty, float> || std::is_same_v<_Ty, double>, "SIMD kernels support float and double only.");
+
+		switch (GetInstructionSet())
+		{
+#if defined(DSP_SIMD_X86)
+		case InstructionSet::avx2:
+			Detail::GoertzelAVX2(samples, sampleCount, coefficients, state1, state2, count);
+			break;
+		case InstructionSet::sse3:
+			Detail::GoertzelSSE3(samples, sampleCount, coefficients, state1, state2, count);
+			break;
+#elif defined(DSP_SIMD_NEON)
+		case InstructionSet::neon:
+			Detail::GoertzelNEON(samples, sampleCount, coefficients, state1, state2, count);
+			break;
+#endif
+		default:
+			Detail::GoertzelScalar(samples, sampleCount, coefficients, state1, state2, count);
+			break;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,405 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "DSPMath.h"
+#include "DSPTypeTraits.h"
+#include "SIMDKernels.h"
+
+namespace DSP
+{
+	// Sliding DFT of the newest windowLength samples of a stream, evaluated at bins k / transformLength of
+	// the sampling frequency for k in a chosen range, as the FFT of the window zero-padded to transformLength
+	// would give them. Each new sample updates the bins in place, at a cost proportional to their number,
+	// so a fresh spectrum is available after any number of samples without transforming the whole window.
+	// Modulated form: resonators sum the samples modulated by twiddle factors taken from a table, no state
+	// is rotated recursively, so rounding errors are not amplified and only add up slowly, in double
+	// precision at least. Cosine-sum windows are applied in the frequency domain, as a combination of
+	// resonators shifted by multiples of 1 / windowLength.
+	template<typename _Ty>
+	class SlidingDFT
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		using complex_t = std::complex<_Ty>;
+		// Resonators accumulate over the whole stream, they are kept in double precision at least
+		using compute_t = std::conditional_t<Is_long_double<_Ty>, long double, double>;
+		using state_t	= std::complex<compute_t>;
+
+		static constexpr std::array<compute_t, 1> s_rectangularWindow{ 1 };
+
+		// Weights of the resonators of a bin, shifted by j / windowLength for j in [-(terms - 1), terms - 1]
+		std::vector<compute_t>	m_weights;
+		// exp(-2 * pi * i * m / transformLength) and exp(2 * pi * i * m / windowLength)
+		std::vector<state_t>	m_binTwiddles;
+		std::vector<state_t>	m_shiftTwiddles;
+		// Resonators, binCount of each shift in turn, so that a shift updates a contiguous array
+		std::vector<state_t>	m_resonators;
+		// Difference of the newest and the oldest sample modulated by the twiddles of each bin
+		std::vector<state_t>	m_modulated;
+		// Last windowLength samples, sample n at position n mod windowLength
+		std::vector<_Ty>		m_history;
+
+		size_t					m_windowLength;
+		size_t					m_transformLength;
+		size_t					m_firstBin;
+		size_t					m_binCount;
+		size_t					m_sampleCount;
+
+		// Phases of the next sample n as table indices: n mod windowLength, n mod transformLength,
+		// (n - windowLength) mod transformLength and firstBin times each of the latter two
+		size_t					m_position;
+		size_t					m_newestStep;
+		size_t					m_oldestStep;
+		size_t					m_newestIndex;
+		size_t					m_oldestIndex;
+		// j * n mod windowLength of each shift
+		std::vector<size_t>		m_shiftIndices;
+
+		// a * b mod m without overflow of the product
+		static size_t MultiplyModulo(size_t a, size_t b, size_t m) noexcept;
+
+		// Add the newest sample and remove the oldest one from the resonators, advance the phases by a sample
+		void Update(compute_t newest, compute_t oldest) noexcept;
+
+		// Set the phases of the bins from the phases of the next sample
+		void UpdateBinIndices() noexcept;
+
+	public:
+
+		// Empty transform, has to be replaced by a constructed one before use
+		SlidingDFT() noexcept;
+
+		// Rectangular window of windowLength samples, bins [firstBin, firstBin + binCount) of a transformLength-point DFT
+		SlidingDFT(size_t windowLength, size_t transformLength, size_t firstBin, size_t binCount);
+
+		// Cosine-sum window a0 - a1 * cos(2 * pi * n / N) + a2 * cos(4 * pi * n / N) - ... with coefficients [first, last),
+		// as generated by WindowGenerator. Each coefficient past a0 adds two resonators per bin.
+		template<typename _InIt>
+		SlidingDFT(size_t windowLength, size_t transformLength, size_t firstBin, size_t binCount, _InIt first, _InIt last);
+
+		// Check if the transform was constructed
+		explicit operator bool() const noexcept;
+
+		size_t GetWindowLength() const noexcept;
+		size_t GetTransformLength() const noexcept;
+		size_t GetFirstBin() const noexcept;
+		size_t GetBinCount() const noexcept;
+
+		// Check if a whole window was processed since the construction or the last Reset()
+		bool IsFilled() const noexcept;
+
+		// Clear the stream, it starts over from silence
+		void Reset() noexcept;
+
+		// Change the evaluated bins. Resonators are computed again from the kept samples, which costs as much
+		// as processing a whole window.
+		void SetBinRange(size_t firstBin, size_t binCount);
+
+		// Append [first, last) to the stream
+		template<typename _InIt>
+		void Process(_InIt first, _InIt last) noexcept;
+
+		// Write GetBinCount() windowed bins of the newest window to dest, with the phase of an FFT of the window
+		template<typename _OutIt>
+		void Spectrum(_OutIt dest) const noexcept;
+
+		// Write the newest GetWindowLength() samples to dest, oldest first
+		template<typename _OutIt>
+		void CopyWindow(_OutIt dest) const noexcept;
+	};
+
+	template<typename _Ty>
+	inline SlidingDFT<_Ty>::SlidingDFT() noexcept :
+		m_windowLength		{ 0U },
+		m_transformLength	{ 0U },
+		m_firstBin			{ 0U },
+		m_binCount			{ 0U },
+		m_sampleCount		{ 0U },
+		m_position			{ 0U },
+		m_newestStep		{ 0U },
+		m_oldestStep		{ 0U },
+		m_newestIndex		{ 0U },
+		m_oldestIndex		{ 0U }
+	{
+	}
+
+	template<typename _Ty>
+	inline SlidingDFT<_Ty>::SlidingDFT(size_t windowLength, size_t transformLength, size_t firstBin, size_t binCount) :
+		SlidingDFT(windowLength, transformLength, firstBin, binCount, s_rectangularWindow.begin(), s_rectangularWindow.end())
+	{
+	}
+
+	template<typename _Ty>
+	template<typename _InIt>
+	inline SlidingDFT<_Ty>::SlidingDFT(size_t windowLength, size_t transformLength, size_t firstBin, size_t binCount, _InIt first, _InIt last) :
+		SlidingDFT()
+	{
+		const std::vector<compute_t> coefficients(first, last);
+
+		if (windowLength == 0U || transformLength == 0U)
+		{
+			throw std::invalid_argument("Window and transform length must be positive.");
+		}
+
+		if (firstBin + binCount > transformLength / 2U + 1U)
+		{
+			throw std::invalid_argument("Bins must be in range [0, transformLength / 2].");
+		}
+
+		if (coefficients.empty() || coefficients.size() > windowLength)
+		{
+			throw std::invalid_argument("Window must have between 1 and windowLength coefficients.");
+		}
+
+		m_windowLength		= windowLength;
+		m_transformLength	= transformLength;
+
+		// cos(x) = (exp(ix) + exp(-ix)) / 2 and the signs of the coefficients alternate
+		const size_t shiftCount = coefficients.size() - 1U;
+		m_weights.resize(2U * shiftCount + 1U);
+
+		for (size_t term = 0U; term < coefficients.size(); term++)
+		{
+			const compute_t weight = (term % 2U == 0U ? coefficients[term] : -coefficients[term]) / (term > 0U ? static_cast<compute_t>(2) : static_cast<compute_t>(1));
+
+			m_weights[shiftCount + term] = weight;
+			m_weights[shiftCount - term] = weight;
+		}
+
+		m_binTwiddles.resize(transformLength);
+		m_shiftTwiddles.resize(windowLength);
+
+		for (size_t m = 0U; m < transformLength; m++)
+		{
+			m_binTwiddles[m] = std::polar(static_cast<compute_t>(1), static_cast<compute_t>(-2) * pi<compute_t> * static_cast<compute_t>(m) / static_cast<compute_t>(transformLength));
+		}
+
+		for (size_t m = 0U; m < windowLength; m++)
+		{
+			m_shiftTwiddles[m] = std::polar(static_cast<compute_t>(1), static_cast<compute_t>(2) * pi<compute_t> * static_cast<compute_t>(m) / static_cast<compute_t>(windowLength));
+		}
+
+		m_shiftIndices.resize(m_weights.size());
+		m_history.resize(windowLength);
+
+		m_firstBin = firstBin;
+		m_binCount = binCount;
+		m_resonators.resize(binCount * m_weights.size());
+		m_modulated.resize(binCount);
+
+		Reset();
+	}
+
+	template<typename _Ty>
+	inline SlidingDFT<_Ty>::operator bool() const noexcept
+	{
+		return m_windowLength > 0U;
+	}
+
+	template<typename _Ty>
+	inline size_t SlidingDFT<_Ty>::GetWindowLength() const noexcept
+	{
+		return m_windowLength;
+	}
+
+	template<typename _Ty>
+	inline size_t SlidingDFT<_Ty>::GetTransformLength() const noexcept
+	{
+		return m_transformLength;
+	}
+
+	template<typename _Ty>
+	inline size_t SlidingDFT<_Ty>::GetFirstBin() const noexcept
+	{
+		return m_firstBin;
+	}
+
+	template<typename _Ty>
+	inline size_t SlidingDFT<_Ty>::GetBinCount() const noexcept
+	{
+		return m_binCount;
+	}
+
+	template<typename _Ty>
+	inline bool SlidingDFT<_Ty>::IsFilled() const noexcept
+	{
+		return m_windowLength > 0U && m_sampleCount >= m_windowLength;
+	}
+
+	template<typename _Ty>
+	inline void SlidingDFT<_Ty>::Reset() noexcept
+	{
+		std::fill(m_history.begin(), m_history.end(), static_cast<_Ty>(0));
+		std::fill(m_resonators.begin(), m_resonators.end(), state_t(0));
+		std::fill(m_shiftIndices.begin(), m_shiftIndices.end(), size_t{ 0U });
+
+		m_sampleCount	= 0U;
+		m_position		= 0U;
+		m_newestStep	= 0U;
+		m_oldestStep	= m_windowLength > 0U ? (m_transformLength - m_windowLength % m_transformLength) % m_transformLength : 0U;
+
+		UpdateBinIndices();
+	}
+
+	template<typename _Ty>
+	inline void SlidingDFT<_Ty>::SetBinRange(size_t firstBin, size_t binCount)
+	{
+		if (firstBin + binCount > m_transformLength / 2U + 1U)
+		{
+			throw std::invalid_argument("Bins must be in range [0, transformLength / 2].");
+		}
+
+		m_firstBin = firstBin;
+		m_binCount = binCount;
+		m_resonators.assign(binCount * m_weights.size(), state_t(0));
+		m_modulated.resize(binCount);
+
+		// Phases go back by a window, which is replayed into the empty resonators. Shifts repeat every window.
+		m_newestStep = m_oldestStep;
+		m_oldestStep = (m_oldestStep + m_transformLength - m_windowLength % m_transformLength) % m_transformLength;
+		UpdateBinIndices();
+
+		for (size_t n = 0U; n < m_windowLength; n++)
+		{
+			Update(static_cast<compute_t>(m_history[m_position]), static_cast<compute_t>(0));
+		}
+	}
+
+	template<typename _Ty>
+	inline size_t SlidingDFT<_Ty>::MultiplyModulo(size_t a, size_t b, size_t m) noexcept
+	{
+		return static_cast<size_t>(static_cast<uint64_t>(a % m) * static_cast<uint64_t>(b % m) % static_cast<uint64_t>(m));
+	}
+
+	template<typename _Ty>
+	inline void SlidingDFT<_Ty>::UpdateBinIndices() noexcept
+	{
+		m_newestIndex = m_transformLength > 0U ? MultiplyModulo(m_firstBin, m_newestStep, m_transformLength) : 0U;
+		m_oldestIndex = m_transformLength > 0U ? MultiplyModulo(m_firstBin, m_oldestStep, m_transformLength) : 0U;
+	}
+
+	template<typename _Ty>
+	inline void SlidingDFT<_Ty>::Update(compute_t newest, compute_t oldest) noexcept
+	{
+		const size_t shiftCount		= m_weights.size() / 2U;
+		const size_t weightCount	= m_weights.size();
+		const size_t length			= m_transformLength;
+
+		// Resonator j of bin k sums x[n] * exp(-2 * pi * i * n * (k / transformLength - j / windowLength)),
+		// the sample is modulated by the bin twiddle first and by the shift twiddle in the loops below.
+		// Parts are accessed as an array, copies of std::complex are packed through the stack.
+		const compute_t* twiddles	= reinterpret_cast<const compute_t*>(m_binTwiddles.data());
+		compute_t* modulated		= reinterpret_cast<compute_t*>(m_modulated.data());
+
+		size_t newestIndex = m_newestIndex;
+		size_t oldestIndex = m_oldestIndex;
+
+		for (size_t bin = 0U; bin < m_binCount; bin++)
+		{
+			modulated[2U * bin]			= newest * twiddles[2U * newestIndex] - oldest * twiddles[2U * oldestIndex];
+			modulated[2U * bin + 1U]	= newest * twiddles[2U * newestIndex + 1U] - oldest * twiddles[2U * oldestIndex + 1U];
+
+			newestIndex += m_newestStep;
+			oldestIndex += m_oldestStep;
+			newestIndex = newestIndex >= length ? newestIndex - length : newestIndex;
+			oldestIndex = oldestIndex >= length ? oldestIndex - length : oldestIndex;
+		}
+
+		for (size_t shift = 0U; shift < weightCount; shift++)
+		{
+			SIMD::MultiplyAccumulate(m_modulated.data(), m_shiftTwiddles[m_shiftIndices[shift]], m_resonators.data() + shift * m_binCount, m_binCount);
+		}
+
+		// Next sample
+		for (size_t shift = 0U; shift < weightCount; shift++)
+		{
+			// Shift j = shift - shiftCount advances by j, negative ones by windowLength + j
+			const size_t step		= (m_windowLength + shift - shiftCount) % m_windowLength;
+			m_shiftIndices[shift]	= (m_shiftIndices[shift] + step) % m_windowLength;
+		}
+
+		m_position		= m_position + 1U == m_windowLength ? 0U : m_position + 1U;
+		m_newestStep	= m_newestStep + 1U == length ? 0U : m_newestStep + 1U;
+		m_oldestStep	= m_oldestStep + 1U == length ? 0U : m_oldestStep + 1U;
+
+		// firstBin * n mod transformLength grows by firstBin per sample
+		const size_t firstBinStep = m_firstBin % length;
+		m_newestIndex = (m_newestIndex + firstBinStep) % length;
+		m_oldestIndex = (m_oldestIndex + firstBinStep) % length;
+	}
+
+	template<typename _Ty>
+	template<typename _InIt>
+	inline void SlidingDFT<_Ty>::Process(_InIt first, _InIt last) noexcept
+	{
+		static_assert(Is_same<Iterator_value_type<_InIt>, _Ty>, "Different value types.");
+
+		for (; first != last; ++first)
+		{
+			const _Ty sample	= *first;
+			const _Ty oldest	= m_history[m_position];
+			m_history[m_position] = sample;
+
+			Update(static_cast<compute_t>(sample), static_cast<compute_t>(oldest));
+			m_sampleCount = std::min(m_sampleCount + 1U, m_windowLength);
+		}
+	}
+
+	template<typename _Ty>
+	template<typename _OutIt>
+	inline void SlidingDFT<_Ty>::Spectrum(_OutIt dest) const noexcept
+	{
+		// Window starts at s = n - windowLength, where n is the next sample. Resonators are referred to sample 0,
+		// bin k is brought to the window start by exp(2 * pi * i * k * s / transformLength) and resonator j
+		// by exp(-2 * pi * i * j * s / windowLength), s = n modulo windowLength.
+		const size_t weightCount = m_weights.size();
+
+		size_t index = m_oldestIndex;
+
+		for (size_t bin = 0U; bin < m_binCount; bin++, ++dest)
+		{
+			compute_t re = static_cast<compute_t>(0);
+			compute_t im = static_cast<compute_t>(0);
+
+			for (size_t shift = 0U; shift < weightCount; shift++)
+			{
+				// Conjugate of the shift twiddle at the next sample
+				const state_t phasor	= m_shiftTwiddles[m_shiftIndices[shift]];
+				const compute_t weight	= m_weights[shift];
+				const compute_t wRe		= weight * phasor.real();
+				const compute_t wIm		= -weight * phasor.imag();
+
+				const state_t resonator = m_resonators[shift * m_binCount + bin];
+
+				re += wRe * resonator.real() - wIm * resonator.imag();
+				im += wRe * resonator.imag() + wIm * resonator.real();
+			}
+
+			// Conjugate of the bin twiddle at the window start
+			const state_t twiddle	= m_binTwiddles[index];
+			const compute_t tRe		= twiddle.real();
+			const compute_t tIm		= -twiddle.imag();
+
+			*dest = complex_t(static_cast<_Ty>(re * tRe - im * tIm), static_cast<_Ty>(re * tIm + im * tRe));
+
+			index += m_oldestStep;
+			index = index >= m_transformLength ? index - m_transformLength : index;
+		}
+	}
+
+	template<typename _Ty>
+	template<typename _OutIt>
+	inline void SlidingDFT<_Ty>::CopyWindow(_OutIt dest) const noexcept
+	{
+		// Oldest sample is where the next one will be written
+		dest = std::copy(std::next(m_history.begin(), m_position), m_history.end(), dest);
+		std::copy(m_history.begin(), std::next(m_history.begin(), m_position), dest);
+	}
+}
@@ -1,45 +1,72 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
 #include "DSPMath.h"
 
 namespace DSP
 {
 	class WindowGenerator
 	{
+		// Windows are computed in blocks of that length, each block independent of the others
+		static constexpr size_t s_blockLength{ 1024U };
+		// From that length on blocks are computed in parallel
+		static constexpr size_t s_parallelMinWindowLength{ 1U << 16 };
+
+		// Cosine recurrence runs in double precision at least, so float windows do not accumulate rounding errors
+		template<typename _Ty>
+		using Compute_type = std::conditional_t<std::is_same_v<_Ty, long double>, long double, double>;
+
+		// Call function(blockFirst, blockLast) for consecutive blocks of indices [0, count)
+		template<typename _Fn>
+		static void ForEachBlock(size_t count, _Fn function) noexcept;
+
+		// Generate cosine-sum window a0 - a1 * cos(2 * pi * n / N) + a2 * cos(4 * pi * n / N) - ...
+		template<typename _RanIt, size_t _Terms>
+		static void GenerateCosineSumWindow(_RanIt first, const _RanIt last, const std::array<long double, _Terms>& coefficients) noexcept;
+
 		// Generate Gaussian window coefficients
-		template<typename _InIt>
-		static void GenerateGaussianWindow(_InIt first, const _InIt last) noexcept;
+		template<typename _RanIt>
+		static void GenerateGaussianWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Triangular window coefficients
-		template<typename _InIt>
-		static void GenerateTriangularWindow(_InIt first, const _InIt last) noexcept;
+		template<typename _RanIt>
+		static void GenerateTriangularWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Welch window coefficients
-		template<typename _InIt>
-		static void GenerateWelchWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateWelchWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Hann window coefficients
-		template<typename _InIt>
-		static void GenerateHannWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateHannWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Hamming window coefficients
-		template<typename _InIt>
-		static void GenerateHammingWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateHammingWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Blackman window coefficients
-		template<typename _InIt>
-		static void GenerateBlackmanWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateBlackmanWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Blckman-Nuttall window coefficients
-		template<typename _InIt>
-		static void GenerateBlackmanNuttallWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateBlackmanNuttallWindow(_RanIt first, const _RanIt last) noexcept;
 
 		// Generate Blackman-Harris window coefficients
-		template<typename _InIt>
-		static void GenerateBlackmanHarrisWindow(_InIt first, _InIt const last) noexcept;
+		template<typename _RanIt>
+		static void GenerateBlackmanHarrisWindow(_RanIt first, const _RanIt last) noexcept;
 
 	public:
 
-		enum class WindowType { 
+		// Coefficients a0, a1, ... of the Blackman-Harris window as a cosine-sum window, e.g. for windowing in the frequency domain
+		static constexpr std::array<long double, 4> s_blackmanHarrisCoefficients{ 0.35875L, 0.48829L, 0.14128L, 0.01168L };
+
+		enum class WindowType {
 			Gauss,
 			Triangular,
 			Welch,
@@ -51,161 +78,180 @@ namespace DSP
 		};
 
 		// Generate the choosen window
-		template<typename _InIt>
-		static void Generate(WindowType type, _InIt first, const _InIt last) noexcept;
+		template<typename _RanIt>
+		static void Generate(WindowType type, _RanIt first, const _RanIt last) noexcept;
 	};
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateGaussianWindow(_InIt first, const _InIt last) noexcept
+	template<typename _Fn>
+	inline void WindowGenerator::ForEachBlock(size_t count, _Fn function) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
+		auto ProcessRange = [&function](size_t rangeFirst, size_t rangeLast) {
+			for (size_t blockFirst = rangeFirst; blockFirst < rangeLast; blockFirst += s_blockLength)
+			{
+				function(blockFirst, std::min(blockFirst + s_blockLength, rangeLast));
+			}
+		};
 
-		constexpr value_t alpha{ static_cast<value_t>(2.5) };
-		const diff_t N = std::distance(first, last);
-		const value_t step = (static_cast<value_t>(N) - static_cast<value_t>(1)) / static_cast<value_t>(2);
+		if (count < s_parallelMinWindowLength)
+		{
+			ProcessRange(0U, count);
+			return;
+		}
+
+		// Each thread gets a range of whole blocks
+		constexpr size_t maxChunkCount = 64U;
+
+		const size_t blockCount		= (count + s_blockLength - 1U) / s_blockLength;
+		const size_t chunkCount		= std::min(maxChunkCount, blockCount);
+		const size_t chunkLength	= (blockCount + chunkCount - 1U) / chunkCount * s_blockLength;
 
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N, &alpha, &step](value_t& val) {
-			val = std::exp(static_cast<value_t>(-0.5) * std::pow((alpha * n / step), 2));
-			n++;
+		std::array<size_t, maxChunkCount> chunks;
+		std::iota(chunks.begin(), std::next(chunks.begin(), chunkCount), size_t{ 0U });
+
+		std::for_each(std::execution::par_unseq, chunks.begin(), std::next(chunks.begin(), chunkCount), [&ProcessRange, chunkLength, count](size_t chunk) {
+			const size_t chunkFirst = std::min(chunk * chunkLength, count);
+			ProcessRange(chunkFirst, std::min(chunkFirst + chunkLength, count));
 		});
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateTriangularWindow(_InIt first, const _InIt last) noexcept
+	template<typename _RanIt, size_t _Terms>
+	inline void WindowGenerator::GenerateCosineSumWindow(_RanIt first, const _RanIt last, const std::array<long double, _Terms>& coefficients) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
+		static_assert(_Terms > 0U, "Cosine-sum window needs at least one term.");
+
+		using value_t	= Iterator_value_type<_RanIt>;
+		using compute_t	= Compute_type<value_t>;
+
+		const size_t N			= static_cast<size_t>(std::distance(first, last));
+		const compute_t omega	= static_cast<compute_t>(2) * pi<compute_t> / static_cast<compute_t>(N);
 
-		const diff_t N = std::distance(first, last);
+		// cos(n * omega) is the real part of a unit phasor rotated by omega per sample
+		const compute_t rotationRe = std::cos(omega);
+		const compute_t rotationIm = std::sin(omega);
 
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N](value_t& val) {
-			val = static_cast<value_t>(1) - std::abs((n - static_cast<value_t>(N) / static_cast<value_t>(2)) / static_cast<value_t>(N));
-			n++;
+		std::array<compute_t, _Terms> a;
+		std::transform(coefficients.begin(), coefficients.end(), a.begin(), [](long double coefficient) {
+			return static_cast<compute_t>(coefficient);
+		});
+
+		ForEachBlock(N, [=](size_t blockFirst, size_t blockLast) {
+			// Phasor starts from the exact phase of each block, so rounding errors of the recurrence
+			// never accumulate over more than s_blockLength samples
+			compute_t re = std::cos(omega * static_cast<compute_t>(blockFirst));
+			compute_t im = std::sin(omega * static_cast<compute_t>(blockFirst));
+
+			for (size_t n = blockFirst; n < blockLast; n++)
+			{
+				// (-1)^k * cos(k * x) = T_k(-cos(x)), the sum is a Chebyshev series of -cos(x) evaluated
+				// with Clenshaw's recurrence, no cosine of the harmonics is computed
+				const compute_t x = -re;
+				compute_t b1 = static_cast<compute_t>(0);
+				compute_t b2 = static_cast<compute_t>(0);
+
+				for (size_t k = _Terms - 1U; k > 0U; k--)
+				{
+					const compute_t b0 = a[k] + static_cast<compute_t>(2) * x * b1 - b2;
+					b2 = b1;
+					b1 = b0;
+				}
+
+				first[n] = static_cast<value_t>(a[0] + x * b1 - b2);
+
+				const compute_t nextRe	= re * rotationRe - im * rotationIm;
+				im						= re * rotationIm + im * rotationRe;
+				re						= nextRe;
+			}
 		});
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateWelchWindow(_InIt first, _InIt const last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateGaussianWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
+		using value_t = Iterator_value_type<_RanIt>;
 
-		const diff_t N = std::distance(first, last);
-
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N](value_t& val) {
-			val = static_cast<value_t>(1) - std::pow((n - static_cast<value_t>(N) / static_cast<value_t>(2)) / (static_cast<value_t>(N) / static_cast<value_t>(2)), 2);
-			n++;
+		constexpr value_t alpha{ static_cast<value_t>(2.5) };
+		const size_t N			= static_cast<size_t>(std::distance(first, last));
+		const value_t center	= (static_cast<value_t>(N) - static_cast<value_t>(1)) / static_cast<value_t>(2);
+		const value_t scale		= alpha / center;
+
+		ForEachBlock(N, [=](size_t blockFirst, size_t blockLast) {
+			for (size_t n = blockFirst; n < blockLast; n++)
+			{
+				const value_t x = scale * (static_cast<value_t>(n) - center);
+				first[n] = std::exp(static_cast<value_t>(-0.5) * x * x);
+			}
 		});
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateHannWindow(_InIt first, _InIt const last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateTriangularWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
+		using value_t = Iterator_value_type<_RanIt>;
 
-		const diff_t N = std::distance(first, last);
+		const size_t N			= static_cast<size_t>(std::distance(first, last));
+		const value_t halfWidth	= static_cast<value_t>(N) / static_cast<value_t>(2);
 
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N](value_t& val) {
-			val = std::pow(std::sin((pi<value_t> * n / static_cast<value_t>(N))), 2);
-			n++;
+		ForEachBlock(N, [=](size_t blockFirst, size_t blockLast) {
+			for (size_t n = blockFirst; n < blockLast; n++)
+			{
+				first[n] = static_cast<value_t>(1) - std::abs((static_cast<value_t>(n) - halfWidth) / halfWidth);
+			}
 		});
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateHammingWindow(_InIt first, _InIt const last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateWelchWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
+		using value_t = Iterator_value_type<_RanIt>;
 
-		constexpr value_t a0{ static_cast<value_t>(25) / static_cast<value_t>(46) };
-		constexpr value_t a1{ 1.0 - a0 };
+		const size_t N			= static_cast<size_t>(std::distance(first, last));
+		const value_t halfWidth	= static_cast<value_t>(N) / static_cast<value_t>(2);
 
-		const diff_t N = std::distance(first, last);
-
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N, &a0, &a1](value_t& val) {
-			val = a0 + a1 * std::cos(static_cast<value_t>(2) * pi<value_t> * n / static_cast<value_t>(N));
-			n++;
+		ForEachBlock(N, [=](size_t blockFirst, size_t blockLast) {
+			for (size_t n = blockFirst; n < blockLast; n++)
+			{
+				const value_t x = (static_cast<value_t>(n) - halfWidth) / halfWidth;
+				first[n] = static_cast<value_t>(1) - x * x;
+			}
 		});
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateBlackmanWindow(_InIt first, _InIt const last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateHannWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
-
-		constexpr value_t a0{ static_cast<value_t>(7938) / static_cast<value_t>(18608) };
-		constexpr value_t a1{ static_cast<value_t>(9240) / static_cast<value_t>(18608) };
-		constexpr value_t a2{ static_cast<value_t>(1430) / static_cast<value_t>(18608) };
+		// sin^2(pi * n / N) = 0.5 - 0.5 * cos(2 * pi * n / N)
+		GenerateCosineSumWindow(first, last, std::array<long double, 2>{ 0.5L, 0.5L });
+	}
 
-		const diff_t N = std::distance(first, last);
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateHammingWindow(_RanIt first, const _RanIt last) noexcept
+	{
+		GenerateCosineSumWindow(first, last, std::array<long double, 2>{ 25.0L / 46.0L, 21.0L / 46.0L });
+	}
 
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N, &a0, &a1, &a2](value_t& val) {
-			val = a0 -
-				a1 * std::cos(static_cast<value_t>(2) * pi<value_t> * n / static_cast<value_t>(N)) +
-				a2 * std::cos(static_cast<value_t>(4) * pi<value_t> * n / static_cast<value_t>(N));
-			n++;
-		});
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateBlackmanWindow(_RanIt first, const _RanIt last) noexcept
+	{
+		GenerateCosineSumWindow(first, last, std::array<long double, 3>{ 7938.0L / 18608.0L, 9240.0L / 18608.0L, 1430.0L / 18608.0L });
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateBlackmanNuttallWindow(_InIt first, const _InIt last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateBlackmanNuttallWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
-
-		constexpr value_t a0{ static_cast<value_t>(0.3635819) };
-		constexpr value_t a1{ static_cast<value_t>(0.4891775) };
-		constexpr value_t a2{ static_cast<value_t>(0.1365995) };
-		constexpr value_t a3{ static_cast<value_t>(0.0106411) };
-
-		const diff_t N = std::distance(first, last);
-		
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N, &a0, &a1, &a2, &a3](value_t& val) {
-			val = a0 -
-				a1 * std::cos(static_cast<value_t>(2) * pi<value_t> * n / static_cast<value_t>(N)) +
-				a2 * std::cos(static_cast<value_t>(4) * pi<value_t> * n / static_cast<value_t>(N)) -
-				a3 * std::cos(static_cast<value_t>(6) * pi<value_t> * n / static_cast<value_t>(N));
-			n++;
-		});
+		GenerateCosineSumWindow(first, last, std::array<long double, 4>{ 0.3635819L, 0.4891775L, 0.1365995L, 0.0106411L });
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::GenerateBlackmanHarrisWindow(_InIt first, const _InIt last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::GenerateBlackmanHarrisWindow(_RanIt first, const _RanIt last) noexcept
 	{
-		using value_t = typename std::iterator_traits<_InIt>::value_type;
-		using diff_t = typename std::iterator_traits<_InIt>::difference_type;
-
-		constexpr value_t a0{ static_cast<value_t>(0.35875) };
-		constexpr value_t a1{ static_cast<value_t>(0.48829) };
-		constexpr value_t a2{ static_cast<value_t>(0.14128) };
-		constexpr value_t a3{ static_cast<value_t>(0.01168) };
-
-		const diff_t N = std::distance(first, last);
-
-		value_t n = 0;
-		std::for_each(first, last, [&n, &N, &a0, &a1, &a2, &a3](value_t& val) {
-			val = a0 -
-				a1 * std::cos(static_cast<value_t>(2) * pi<value_t> * static_cast<value_t>(n) / static_cast<value_t>(N)) +
-				a2 * std::cos(static_cast<value_t>(4) * pi<value_t> * static_cast<value_t>(n) / static_cast<value_t>(N)) -
-				a3 * std::cos(static_cast<value_t>(6) * pi<value_t> * static_cast<value_t>(n) / static_cast<value_t>(N));
-			n++;
-		});
+		GenerateCosineSumWindow(first, last, s_blackmanHarrisCoefficients);
 	}
 
-	template<typename _InIt>
-	inline void WindowGenerator::Generate(WindowGenerator::WindowType type, _InIt first, const _InIt last) noexcept
+	template<typename _RanIt>
+	inline void WindowGenerator::Generate(WindowGenerator::WindowType type, _RanIt first, const _RanIt last) noexcept
 	{
-		static_assert(std::is_floating_point<std::iterator_traits<_InIt>::value_type>(), "value_t must be of a floating point type.");
+		static_assert(std::is_floating_point<typename std::iterator_traits<_RanIt>::value_type>(), "value_t must be of a floating point type.");
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<_RanIt>::iterator_category>, "Coefficients are computed by index.");
 
 		switch (type) {
 		case WindowType::Gauss:				WindowGenerator::GenerateGaussianWindow(first, last);			break;
@@ -0,0 +1,221 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include "DSPTypeTraits.h"
+#include "FFTPlan.h"
+
+namespace DSP
+{
+	// Kind of transform computed by a plan
+	enum class transform
+	{
+		r2c,
+		c2r,
+		c2c
+	};
+
+	// Plan the wisdom is stored for
+	struct WisdomKey
+	{
+		transform	kind;
+		// Number of points of the transform, length of the real signal for real transforms
+		size_t		fftSize;
+		// Flags the plan is measured with
+		flags		planFlags{ flags::measure };
+	};
+
+	// FFTW wisdom kept in a directory, one entry per precision, transform kind, size and flags,
+	// so that each configuration keeps its plans. Entries are replaced atomically and verified
+	// before they are imported. Wisdom is global, an entry holds all wisdom of its precision
+	// known when it was saved and loading several entries merges them.
+	template<typename _Ty>
+	class WisdomStore
+	{
+		static_assert(Is_floating_point<_Ty>, "Value type must be floating point.");
+
+		static constexpr const char* s_magic{ "DSPWISDOM" };
+		static constexpr uint32_t s_version{ 1U };
+
+		std::filesystem::path m_directory;
+
+		static const char* GetPrecisionName() noexcept;
+		static const char* GetTransformName(transform kind) noexcept;
+
+		// FNV-1a hash detecting truncated or modified entries
+		static uint64_t GetChecksum(const std::string& data) noexcept;
+
+		// First line of an entry, identifies the key and the wisdom following it
+		static std::string GetHeader(const WisdomKey& key, const std::string& wisdom);
+
+	public:
+
+		// Store in the given directory, created on the first Save()
+		explicit WisdomStore(std::filesystem::path directory);
+
+		const std::filesystem::path& GetDirectory() const noexcept;
+
+		// Path of the entry of the given plan
+		std::filesystem::path GetEntryPath(const WisdomKey& key) const;
+
+		// Import the wisdom stored for the plan. Returns false if there is no entry,
+		// it was written for another plan or it is corrupted.
+		bool Load(const WisdomKey& key) const;
+
+		// Store wisdom of this precision for the plan, replacing its previous entry.
+		// Returns false if the entry could not be written, the previous one is then kept.
+		bool Save(const WisdomKey& key) const;
+	};
+
+	template<typename _Ty>
+	inline WisdomStore<_Ty>::WisdomStore(std::filesystem::path directory) :
+		m_directory{ std::move(directory) }
+	{
+	}
+
+	template<typename _Ty>
+	inline const char* WisdomStore<_Ty>::GetPrecisionName() noexcept
+	{
+		if constexpr (Is_float<_Ty>)
+		{
+			return "float";
+		}
+		else if constexpr (Is_double<_Ty>)
+		{
+			return "double";
+		}
+		else if constexpr (Is_long_double<_Ty>)
+		{
+			return "longdouble";
+		}
+	}
+
+	template<typename _Ty>
+	inline const char* WisdomStore<_Ty>::GetTransformName(transform kind) noexcept
+	{
+		switch (kind)
+		{
+		case transform::r2c:
+			return "r2c";
+		case transform::c2r:
+			return "c2r";
+		default:
+			return "c2c";
+		}
+	}
+
+	template<typename _Ty>
+	inline uint64_t WisdomStore<_Ty>::GetChecksum(const std::string& data) noexcept
+	{
+		uint64_t hash = 14695981039346656037ULL;
+
+		for (const char c : data)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ULL;
+		}
+
+		return hash;
+	}
+
+	template<typename _Ty>
+	inline std::string WisdomStore<_Ty>::GetHeader(const WisdomKey& key, const std::string& wisdom)
+	{
+		std::ostringstream header;
+		header << s_magic << ' ' << s_version << ' ' << GetPrecisionName() << ' ' << GetTransformName(key.kind) << ' '
+			<< key.fftSize << ' ' << static_cast<int>(key.planFlags) << ' ' << wisdom.size() << ' ' << std::hex << GetChecksum(wisdom);
+
+		return header.str();
+	}
+
+	template<typename _Ty>
+	inline const std::filesystem::path& WisdomStore<_Ty>::GetDirectory() const noexcept
+	{
+		return m_directory;
+	}
+
+	template<typename _Ty>
+	inline std::filesystem::path WisdomStore<_Ty>::GetEntryPath(const WisdomKey& key) const
+	{
+		std::ostringstream fileName;
+		fileName << "fftw_" << GetPrecisionName() << '_' << GetTransformName(key.kind) << '_' << key.fftSize << '_' << static_cast<int>(key.planFlags) << ".wisdom";
+
+		return m_directory / fileName.str();
+	}
+
+	template<typename _Ty>
+	inline bool WisdomStore<_Ty>::Load(const WisdomKey& key) const
+	{
+		std::ifstream file(GetEntryPath(key), std::ios::binary);
+
+		std::string header;
+
+		if (!file || !std::getline(file, header))
+		{
+			return false;
+		}
+
+		const std::string wisdom{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+		// Header holds the length and checksum of the wisdom, so any difference in the key,
+		// a truncated write or a modification makes it differ from the expected one
+		if (header != GetHeader(key, wisdom))
+		{
+			return false;
+		}
+
+		return FFTPlan<_Ty>::ImportWisdom(wisdom);
+	}
+
+	template<typename _Ty>
+	inline bool WisdomStore<_Ty>::Save(const WisdomKey& key) const
+	{
+		const std::string wisdom = FFTPlan<_Ty>::ExportWisdom();
+
+		if (wisdom.empty())
+		{
+			return false;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+
+		if (error)
+		{
+			return false;
+		}
+
+		// Entry is written next to its final path and renamed over it, so readers, also in other
+		// processes, see either the old or the new entry. Random suffix keeps concurrent writers apart.
+		const std::filesystem::path entryPath	= GetEntryPath(key);
+		std::filesystem::path temporaryPath		= entryPath;
+		temporaryPath += ".tmp" + std::to_string(std::random_device{}());
+
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			file << GetHeader(key, wisdom) << '\n' << wisdom;
+			file.close();
+
+			if (!file)
+			{
+				std::filesystem::remove(temporaryPath, error);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporaryPath, entryPath, error);
+
+		if (error)
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,700 @@
+// Tests of the building blocks of the analysis that can run on any platform. Each failed check is reported
+// on the standard error, the exit code is nonzero if any of them failed.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "FFTPlan.h"
+#include "FilterCache.h"
+#include "LatestValueMailbox.h"
+#include "OverlapSaveFilter.h"
+#include "PitchAnalyzer.h"
+#include "SignalGenerator.h"
+#include "SlidingDFT.h"
+#include "WindowGenerator.h"
+#include "WisdomStore.h"
+
+using namespace winrt::Tuner::implementation;
+
+namespace
+{
+	size_t s_failureCount{ 0U };
+
+	void Check(bool condition, const char* test, const char* expression)
+	{
+		if (!condition)
+		{
+			std::cerr << test << ": " << expression << " failed" << std::endl;
+			s_failureCount++;
+		}
+	}
+
+#define CHECK(test, condition) Check((condition), (test), #condition)
+
+	// Mailbox values large enough to span several cache lines, each word holds the sequence number,
+	// so that a value torn by a write to the slot being read is detected
+	struct MailboxValue
+	{
+		std::array<uint64_t, 32U> words;
+
+		void Fill(uint64_t sequence) noexcept
+		{
+			words.fill(sequence);
+		}
+
+		bool IsConsistent() const noexcept
+		{
+			for (const uint64_t word : words)
+			{
+				if (word != words[0])
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+	constexpr size_t s_mailboxConcurrentCount{ 1000000U };
+
+	constexpr size_t s_batchFFTSize{ 64U };
+	constexpr size_t s_batchCount{ 5U };
+	constexpr double s_batchTolerance{ 1e-12 };
+
+	constexpr uint32_t	s_samplingFrequency{ 44100U };
+	constexpr float		s_minFrequency{ 80.0f };
+	constexpr float		s_maxFrequency{ 1200.0f };
+	constexpr float		s_baseToneFrequency{ 440.0f };
+	constexpr double	s_testFrequency{ 110.37 };
+
+	constexpr size_t s_filterCacheCapacity{ 3U };
+
+	constexpr size_t s_overlapSaveStreamLength{ 4096U };
+	constexpr double s_overlapSaveTolerance{ 1e-9 };
+
+	constexpr size_t s_slidingWindowLength{ 256U };
+	constexpr size_t s_slidingTransformLength{ 512U };
+	constexpr double s_slidingTolerance{ 1e-9 };
+
+	// Longest time the measured plan may take before the background planning test gives up
+	constexpr std::chrono::seconds s_backgroundPlanningTimeout{ 120 };
+
+	// Single thread alternating between publishing batches of values and reading them
+	void TestMailboxSequential()
+	{
+		constexpr const char* test = "mailbox sequential";
+
+		LatestValueMailbox<MailboxValue> mailbox;
+		size_t notifications = 0U;
+		mailbox.SetNotification([&notifications]() {
+			notifications++;
+		});
+
+		MailboxValue value{};
+		MailboxValue read{};
+
+		CHECK(test, !mailbox.HasNewValue());
+		CHECK(test, !mailbox.TryRead(read));
+
+		// Single value is handed over without drops
+		value.Fill(1U);
+		mailbox.Publish(value);
+		CHECK(test, notifications == 1U);
+		CHECK(test, mailbox.HasNewValue());
+		CHECK(test, mailbox.TryRead(read) && read.words[0] == 1U);
+		CHECK(test, !mailbox.HasNewValue());
+		CHECK(test, !mailbox.TryRead(read));
+
+		// Batch of three notifies once and the reader gets only the latest
+		for (uint64_t sequence = 2U; sequence <= 4U; sequence++)
+		{
+			value.Fill(sequence);
+			mailbox.Publish(value);
+		}
+
+		CHECK(test, notifications == 2U);
+		CHECK(test, mailbox.TryRead(read) && read.words[0] == 4U);
+
+		MailboxStatistics statistics = mailbox.GetStatistics();
+		CHECK(test, statistics.published == 4U);
+		CHECK(test, statistics.consumed == 2U);
+		CHECK(test, statistics.dropped == 2U);
+		CHECK(test, statistics.coalesced == 1U);
+
+		// Batch longer than the number of slots, the producer cycles through its slot and the shared one
+		value.Fill(5U);
+		mailbox.Publish(value);
+		CHECK(test, mailbox.TryRead(read) && read.words[0] == 5U);
+
+		for (uint64_t sequence = 6U; sequence <= 9U; sequence++)
+		{
+			value.Fill(sequence);
+			mailbox.Publish(value);
+		}
+
+		CHECK(test, notifications == 4U);
+		CHECK(test, mailbox.TryRead(read) && read.words[0] == 9U && read.IsConsistent());
+
+		// Value published but not read yet is neither consumed nor dropped
+		value.Fill(10U);
+		mailbox.Publish(value);
+
+		statistics = mailbox.GetStatistics();
+		CHECK(test, notifications == 5U);
+		CHECK(test, statistics.published == 10U);
+		CHECK(test, statistics.consumed == 4U);
+		CHECK(test, statistics.dropped == 5U);
+		CHECK(test, statistics.coalesced == 2U);
+	}
+
+	// Producer publishes as fast as it can while the consumer reads on another thread
+	void TestMailboxConcurrent()
+	{
+		constexpr const char* test = "mailbox concurrent";
+
+		auto mailbox = std::make_unique<LatestValueMailbox<MailboxValue>>();
+		std::atomic<uint64_t> notifications{ 0U };
+		std::atomic<bool> finished{ false };
+
+		mailbox->SetNotification([&notifications]() {
+			notifications.fetch_add(1U, std::memory_order_relaxed);
+		});
+
+		std::thread producer([&mailbox, &finished]() {
+			MailboxValue value{};
+
+			for (uint64_t sequence = 1U; sequence <= s_mailboxConcurrentCount; sequence++)
+			{
+				value.Fill(sequence);
+				mailbox->Publish(value);
+			}
+
+			finished.store(true, std::memory_order_release);
+		});
+
+		MailboxValue read{};
+		uint64_t last = 0U;
+		uint64_t reads = 0U;
+		bool consistent = true;
+		bool increasing = true;
+
+		// Values published before the producer finished are still read after it
+		while (!finished.load(std::memory_order_acquire) || mailbox->HasNewValue())
+		{
+			if (mailbox->TryRead(read))
+			{
+				consistent	= consistent && read.IsConsistent();
+				increasing	= increasing && read.words[0] > last;
+				last		= read.words[0];
+				reads++;
+			}
+		}
+
+		producer.join();
+
+		// Each read ends the batch started by one notification
+		const MailboxStatistics statistics = mailbox->GetStatistics();
+		CHECK(test, consistent);
+		CHECK(test, increasing);
+		CHECK(test, last == s_mailboxConcurrentCount);
+		CHECK(test, statistics.published == s_mailboxConcurrentCount);
+		CHECK(test, statistics.consumed == reads);
+		CHECK(test, statistics.consumed + statistics.dropped == statistics.published);
+		CHECK(test, statistics.coalesced <= statistics.consumed);
+		CHECK(test, statistics.coalesced <= statistics.dropped);
+		CHECK(test, (statistics.coalesced == 0U) == (statistics.dropped == 0U));
+		CHECK(test, notifications.load() == statistics.consumed);
+	}
+
+	template<typename _Ty>
+	double MaxDifference(const std::vector<_Ty>& a, const std::vector<_Ty>& b)
+	{
+		double difference = 0.0;
+
+		for (size_t i = 0U; i < a.size(); i++)
+		{
+			difference = std::max(difference, static_cast<double>(std::abs(a[i] - b[i])));
+		}
+
+		return difference;
+	}
+
+	// Batched plans give the same transforms as a single plan executed on each of them, also with
+	// interleaved transforms. Layouts the planner cannot take are rejected.
+	void TestBatchFFTPlan()
+	{
+		constexpr const char* test = "batch FFT plan";
+
+		using complex_t	= std::complex<double>;
+		using FFTPlan_t	= DSP::FFTPlan<double>;
+
+		constexpr size_t binCount = s_batchFFTSize / 2U + 1U;
+
+		std::mt19937 generator{ 1U };
+		std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+
+		std::vector<double> signal(s_batchCount * s_batchFFTSize);
+		std::vector<complex_t> complexSignal(s_batchCount * s_batchFFTSize);
+
+		for (double& sample : signal)
+		{
+			sample = distribution(generator);
+		}
+
+		for (complex_t& sample : complexSignal)
+		{
+			sample = complex_t(distribution(generator), distribution(generator));
+		}
+
+		// Real-to-complex, transforms one after another
+		std::vector<complex_t> batchSpectrum(s_batchCount * binCount);
+		std::vector<complex_t> singleSpectrum(s_batchCount * binCount);
+		{
+			const DSP::BatchLayout layout{ s_batchFFTSize, s_batchCount, s_batchFFTSize, binCount };
+			FFTPlan_t batchPlan(layout, signal.begin(), batchSpectrum.begin(), DSP::flags::estimate);
+			FFTPlan_t singlePlan(signal.begin(), std::next(signal.begin(), s_batchFFTSize), singleSpectrum.begin(), DSP::flags::estimate);
+
+			batchPlan.Execute();
+
+			for (size_t k = 0U; k < s_batchCount; k++)
+			{
+				singlePlan.Execute(signal.data() + k * s_batchFFTSize, singleSpectrum.data() + k * binCount);
+			}
+
+			CHECK(test, MaxDifference(batchSpectrum, singleSpectrum) < s_batchTolerance);
+		}
+
+		// Complex-to-real of the spectra above, the plans overwrite their input
+		{
+			std::vector<complex_t> batchInput(singleSpectrum);
+			std::vector<complex_t> singleInput(singleSpectrum);
+			std::vector<double> batchOutput(s_batchCount * s_batchFFTSize);
+			std::vector<double> singleOutput(s_batchCount * s_batchFFTSize);
+
+			const DSP::BatchLayout layout{ s_batchFFTSize, s_batchCount, binCount, s_batchFFTSize };
+			FFTPlan_t batchPlan(layout, batchInput.begin(), batchOutput.begin(), DSP::flags::estimate);
+			FFTPlan_t singlePlan(singleInput.begin(), std::next(singleInput.begin(), binCount), singleOutput.begin(), DSP::flags::estimate);
+
+			batchPlan.Execute();
+
+			for (size_t k = 0U; k < s_batchCount; k++)
+			{
+				singlePlan.Execute(singleInput.data() + k * binCount, singleOutput.data() + k * s_batchFFTSize);
+			}
+
+			CHECK(test, MaxDifference(batchOutput, singleOutput) < s_batchTolerance);
+		}
+
+		// Complex-to-complex of interleaved transforms, sample i of transform k at i * s_batchCount + k
+		{
+			std::vector<complex_t> batchOutput(s_batchCount * s_batchFFTSize);
+			std::vector<complex_t> singleOutput(s_batchCount * s_batchFFTSize);
+			std::vector<complex_t> singleInput(s_batchFFTSize);
+
+			const DSP::BatchLayout layout{ s_batchFFTSize, s_batchCount, 1U, 1U, s_batchCount, s_batchCount };
+			FFTPlan_t batchPlan(layout, complexSignal.begin(), batchOutput.begin(), DSP::flags::estimate, DSP::direction::backward);
+			FFTPlan_t singlePlan(singleInput.begin(), singleInput.end(), singleOutput.begin(), DSP::flags::estimate, DSP::direction::backward);
+
+			batchPlan.Execute();
+
+			for (size_t k = 0U; k < s_batchCount; k++)
+			{
+				for (size_t i = 0U; i < s_batchFFTSize; i++)
+				{
+					singleInput[i] = complexSignal[i * s_batchCount + k];
+				}
+
+				singlePlan.Execute(singleInput.data(), singleOutput.data() + k * s_batchFFTSize);
+			}
+
+			double difference = 0.0;
+
+			for (size_t k = 0U; k < s_batchCount; k++)
+			{
+				for (size_t i = 0U; i < s_batchFFTSize; i++)
+				{
+					difference = std::max(difference, std::abs(batchOutput[i * s_batchCount + k] - singleOutput[k * s_batchFFTSize + i]));
+				}
+			}
+
+			CHECK(test, difference < s_batchTolerance);
+		}
+
+		// Sizes beyond int are rejected before reaching the planner
+		bool rejected = false;
+
+		try
+		{
+			const size_t tooLarge = static_cast<size_t>(std::numeric_limits<int>::max()) + 1U;
+			const DSP::BatchLayout layout{ s_batchFFTSize, s_batchCount, tooLarge, binCount };
+			FFTPlan_t plan(layout, signal.begin(), batchSpectrum.begin(), DSP::flags::estimate);
+		}
+		catch (const std::invalid_argument&)
+		{
+			rejected = true;
+		}
+
+		CHECK(test, rejected);
+	}
+
+	// Band-pass design differing from the others by its low cutoff
+	DSP::FilterDesign GetFilterDesign(float lowCutoff) noexcept
+	{
+		return { lowCutoff, s_maxFrequency, static_cast<float>(s_samplingFrequency), DSP::WindowGenerator::WindowType::BlackmanHarris, 512U };
+	}
+
+	// Found filters become the most recently used, the least recently used one is evicted when the cache
+	// is full and stays valid for those holding it
+	void TestFilterCache()
+	{
+		constexpr const char* test = "filter cache";
+
+		using FilterCache_t = DSP::FilterCache<int>;
+
+		FilterCache_t cache(s_filterCacheCapacity);
+		CHECK(test, cache.GetCapacity() == s_filterCacheCapacity);
+		CHECK(test, cache.GetSize() == 0U);
+		CHECK(test, !cache.Find(GetFilterDesign(1.0f)));
+
+		cache.Insert(GetFilterDesign(1.0f), std::make_shared<const int>(1));
+		cache.Insert(GetFilterDesign(2.0f), std::make_shared<const int>(2));
+		cache.Insert(GetFilterDesign(3.0f), std::make_shared<const int>(3));
+		CHECK(test, cache.GetSize() == 3U);
+
+		std::shared_ptr<const int> filter = cache.Find(GetFilterDesign(1.0f));
+		CHECK(test, filter && *filter == 1);
+
+		// Second filter used before the others is the least recently used one
+		std::shared_ptr<const int> evicted = cache.Find(GetFilterDesign(2.0f));
+		cache.Find(GetFilterDesign(3.0f));
+		cache.Find(GetFilterDesign(1.0f));
+
+		cache.Insert(GetFilterDesign(4.0f), std::make_shared<const int>(4));
+		CHECK(test, cache.GetSize() == s_filterCacheCapacity);
+		CHECK(test, !cache.Find(GetFilterDesign(2.0f)));
+		CHECK(test, evicted && *evicted == 2);
+
+		// Replacing a filter keeps the size and makes it the most recently used, order is now 1, 4, 3
+		cache.Insert(GetFilterDesign(1.0f), std::make_shared<const int>(10));
+		CHECK(test, cache.GetSize() == s_filterCacheCapacity);
+
+		cache.Insert(GetFilterDesign(5.0f), std::make_shared<const int>(5));
+		CHECK(test, !cache.Find(GetFilterDesign(3.0f)));
+
+		filter = cache.Find(GetFilterDesign(1.0f));
+		CHECK(test, filter && *filter == 10);
+		filter = cache.Find(GetFilterDesign(4.0f));
+		CHECK(test, filter && *filter == 4);
+		filter = cache.Find(GetFilterDesign(5.0f));
+		CHECK(test, filter && *filter == 5);
+
+		// Designs differing in any other parameter are different entries
+		DSP::FilterDesign design = GetFilterDesign(5.0f);
+		design.filterSize++;
+		CHECK(test, !cache.Find(design));
+
+		cache.Clear();
+		CHECK(test, cache.GetSize() == 0U);
+		CHECK(test, !cache.Find(GetFilterDesign(5.0f)));
+
+		bool rejected = false;
+
+		try
+		{
+			FilterCache_t emptyCache(0U);
+		}
+		catch (const std::invalid_argument&)
+		{
+			rejected = true;
+		}
+
+		CHECK(test, rejected);
+	}
+
+	// Filters with impulse responses shorter than a block, ending on a partition boundary and one sample past it
+	// match direct convolution of a stream arriving in chunks of random length. Filter takes whole blocks,
+	// chunks are gathered into blocks as an audio callback would, so blocks start anywhere in the chunks.
+	void TestOverlapSaveFilter()
+	{
+		constexpr const char* test = "overlap-save filter";
+
+		std::mt19937 generator{ 1U };
+		std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+
+		std::vector<double> stream(s_overlapSaveStreamLength);
+
+		for (double& sample : stream)
+		{
+			sample = distribution(generator);
+		}
+
+		for (const size_t blockSize : { 64U, 48U })
+		{
+			for (const size_t filterSize : { size_t{ 1U }, size_t{ 37U }, 4U * blockSize, 4U * blockSize + 1U })
+			{
+				std::vector<double> impulseResponse(filterSize);
+
+				for (double& tap : impulseResponse)
+				{
+					tap = distribution(generator);
+				}
+
+				DSP::OverlapSaveFilter<double> filter(impulseResponse.begin(), impulseResponse.end(), blockSize, DSP::flags::estimate);
+
+				std::uniform_int_distribution<size_t> chunkDistribution{ 1U, 3U * blockSize };
+				std::vector<double> block;
+				std::vector<double> output;
+				output.reserve(stream.size());
+
+				for (size_t position = 0U; position < stream.size(); )
+				{
+					const size_t chunkLength = std::min(chunkDistribution(generator), stream.size() - position);
+
+					for (size_t i = position; i < position + chunkLength; i++)
+					{
+						block.push_back(stream[i]);
+
+						if (block.size() == blockSize)
+						{
+							filter.Process(block.begin(), block.end(), block.begin());
+							output.insert(output.end(), block.begin(), block.end());
+							block.clear();
+						}
+					}
+
+					position += chunkLength;
+				}
+
+				// Direct convolution of the samples filtered so far, those before the stream are zeros
+				std::vector<double> expected(output.size(), 0.0);
+				double scale = 0.0;
+
+				for (size_t n = 0U; n < expected.size(); n++)
+				{
+					for (size_t k = 0U; k < filterSize && k <= n; k++)
+					{
+						expected[n] += impulseResponse[k] * stream[n - k];
+					}
+
+					scale = std::max(scale, std::abs(expected[n]));
+				}
+
+				CHECK(test, filter.GetPartitionCount() == (filterSize + blockSize - 1U) / blockSize);
+				CHECK(test, output.size() + blockSize > stream.size());
+				CHECK(test, MaxDifference(output, expected) <= s_overlapSaveTolerance * scale);
+			}
+		}
+	}
+
+	// Bins [firstBin, firstBin + binCount) of the DFT of the windowed samples preceding end, zero-padded to transformLength.
+	// Samples before the start of the stream are zeros.
+	std::vector<std::complex<double>> DirectWindowedDFT(const std::vector<double>& stream, size_t end, const std::vector<double>& window,
+		size_t transformLength, size_t firstBin, size_t binCount)
+	{
+		constexpr double pi = 3.14159265358979323846;
+
+		std::vector<std::complex<double>> bins(binCount);
+
+		for (size_t k = 0U; k < binCount; k++)
+		{
+			for (size_t m = 0U; m < window.size(); m++)
+			{
+				if (end + m >= window.size())
+				{
+					const size_t n		= end + m - window.size();
+					const size_t phase	= (firstBin + k) * m % transformLength;
+					bins[k] += window[m] * stream[n] * std::polar(1.0, -2.0 * pi * static_cast<double>(phase) / static_cast<double>(transformLength));
+				}
+			}
+		}
+
+		return bins;
+	}
+
+	// Streamed Blackman-Harris windowed bins match the direct DFT of the same window after chunks of any length,
+	// also across a change of the bin range, which computes the resonators again from the kept samples
+	void TestSlidingDFT()
+	{
+		constexpr const char* test = "sliding DFT";
+
+		const auto& coefficients = DSP::WindowGenerator::s_blackmanHarrisCoefficients;
+
+		size_t firstBin = 3U;
+		size_t binCount = 40U;
+		DSP::SlidingDFT<double> slidingDFT(s_slidingWindowLength, s_slidingTransformLength, firstBin, binCount, coefficients.begin(), coefficients.end());
+
+		std::vector<double> window(s_slidingWindowLength);
+		DSP::WindowGenerator::Generate(DSP::WindowGenerator::WindowType::BlackmanHarris, window.begin(), window.end());
+
+		std::mt19937 generator{ 1U };
+		std::uniform_real_distribution<double> distribution{ -1.0, 1.0 };
+
+		std::vector<double> stream(4U * s_slidingWindowLength);
+
+		for (double& sample : stream)
+		{
+			sample = distribution(generator);
+		}
+
+		std::vector<std::complex<double>> spectrum;
+		size_t position = 0U;
+		size_t chunk = 0U;
+		bool matches = true;
+
+		// Chunks shorter than, equal to and longer than the window
+		for (const size_t chunkLength : { 1U, 37U, 256U, 300U, 5U, 200U })
+		{
+			slidingDFT.Process(stream.begin() + position, stream.begin() + position + chunkLength);
+			position += chunkLength;
+
+			if (++chunk == 4U)
+			{
+				firstBin = 10U;
+				binCount = 25U;
+				slidingDFT.SetBinRange(firstBin, binCount);
+			}
+
+			spectrum.resize(slidingDFT.GetBinCount());
+			slidingDFT.Spectrum(spectrum.begin());
+
+			const std::vector<std::complex<double>> expected = DirectWindowedDFT(stream, position, window, s_slidingTransformLength, firstBin, binCount);
+
+			double scale = 0.0;
+
+			for (const std::complex<double>& bin : expected)
+			{
+				scale = std::max(scale, std::abs(bin));
+			}
+
+			matches = matches && spectrum.size() == expected.size() && MaxDifference(spectrum, expected) <= s_slidingTolerance * scale;
+		}
+
+		CHECK(test, matches);
+		CHECK(test, slidingDFT.IsFilled());
+		CHECK(test, slidingDFT.GetFirstBin() == firstBin && slidingDFT.GetBinCount() == binCount);
+	}
+
+	// Initialization with background planning returns on an estimated plan, the measured one is swapped
+	// in by the first analysis after it is ready
+	void TestBackgroundPlanning()
+	{
+		constexpr const char* test = "background planning";
+
+		using PitchAnalyzer_t = PitchAnalyzer<8192U, 512U, float>;
+
+		auto analyzer = std::make_unique<PitchAnalyzer_t>(s_minFrequency, s_maxFrequency, s_baseToneFrequency, static_cast<float>(s_samplingFrequency));
+
+		float detectedFrequency = 0.0f;
+		analyzer->SoundAnalyzed([&detectedFrequency](PitchAnalysisResult result) {
+			detectedFrequency = result.frequency;
+		});
+
+		analyzer->Initialize(nullptr, PitchAnalyzer_t::FFTPlanning::background);
+
+		PitchAnalyzer_t::FFTPlanStatistics statistics = analyzer->GetFFTPlanStatistics();
+		CHECK(test, statistics.source == PitchAnalyzer_t::FFTPlanSource::estimate);
+		CHECK(test, statistics.backgroundPlanningPending);
+
+		std::vector<float> input(8192U);
+		auto generator = std::make_unique<SignalGenerator>(s_samplingFrequency, input.size());
+		generator->AddHarmonics(s_testFrequency, 6U, 0.5, 0.6);
+		generator->Generate(input.begin(), input.end());
+
+		// Analysis runs on the estimated plan until the measured one is handed over
+		const auto deadline = std::chrono::steady_clock::now() + s_backgroundPlanningTimeout;
+
+		do
+		{
+			analyzer->Analyze(input.begin(), input.end());
+			statistics = analyzer->GetFFTPlanStatistics();
+		} while (statistics.backgroundPlanningPending && std::chrono::steady_clock::now() < deadline);
+
+		CHECK(test, !statistics.backgroundPlanningPending);
+		CHECK(test, statistics.source == PitchAnalyzer_t::FFTPlanSource::measure);
+		CHECK(test, statistics.backgroundPlanningTime.count() > 0);
+		CHECK(test, std::abs(1200.0 * std::log2(detectedFrequency / s_testFrequency)) < 5.0);
+	}
+
+	// Whether an analyzer initialized with background planning from the store starts on an estimated plan
+	template<size_t s_audioBufferSize>
+	bool IsInitialFFTPlanEstimated(const DSP::WisdomStore<float>& wisdomStore)
+	{
+		using PitchAnalyzer_t = PitchAnalyzer<s_audioBufferSize, 512U, float>;
+
+		auto analyzer = std::make_unique<PitchAnalyzer_t>(s_minFrequency, s_maxFrequency, s_baseToneFrequency, static_cast<float>(s_samplingFrequency));
+		analyzer->Initialize(&wisdomStore, PitchAnalyzer_t::FFTPlanning::background);
+
+		return analyzer->GetFFTPlanStatistics().source == PitchAnalyzer_t::FFTPlanSource::estimate;
+	}
+
+	// Entries written for another plan or truncated are not imported and the analyzer falls back
+	// to an estimated plan. Sizes differ from the other tests, so no wisdom of them is known yet,
+	// and the smaller one is measured first, so it is not part of the wisdom of the larger one.
+	void TestWisdomStore()
+	{
+		constexpr const char* test = "wisdom store";
+
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("TunerTests" + std::to_string(std::random_device{}()));
+		const DSP::WisdomStore<float> wisdomStore{ directory };
+
+		const DSP::WisdomKey truncatedKey{ DSP::transform::r2c, 2048U };
+		const DSP::WisdomKey wrongKey{ DSP::transform::r2c, 4096U };
+
+		// Entry saved for a plan is loaded back
+		CHECK(test, wisdomStore.Save(truncatedKey));
+		CHECK(test, wisdomStore.Load(truncatedKey));
+
+		// Entry of the first plan stored as the entry of the second one
+		std::error_code error;
+		std::filesystem::copy_file(wisdomStore.GetEntryPath(truncatedKey), wisdomStore.GetEntryPath(wrongKey), error);
+		CHECK(test, !error);
+		CHECK(test, !wisdomStore.Load(wrongKey));
+
+		// Entry missing its last byte
+		const uintmax_t entrySize = std::filesystem::file_size(wisdomStore.GetEntryPath(truncatedKey), error);
+		CHECK(test, !error && entrySize > 0U);
+		std::filesystem::resize_file(wisdomStore.GetEntryPath(truncatedKey), entrySize - 1U, error);
+		CHECK(test, !error);
+		CHECK(test, !wisdomStore.Load(truncatedKey));
+
+		CHECK(test, IsInitialFFTPlanEstimated<2048U>(wisdomStore));
+		CHECK(test, IsInitialFFTPlanEstimated<4096U>(wisdomStore));
+
+		std::filesystem::remove_all(directory, error);
+	}
+}
+
+int main()
+{
+	TestMailboxSequential();
+	TestMailboxConcurrent();
+	TestBatchFFTPlan();
+	TestFilterCache();
+	TestOverlapSaveFilter();
+	TestSlidingDFT();
+	TestBackgroundPlanning();
+	TestWisdomStore();
+
+	if (s_failureCount > 0U)
+	{
+		std::cerr << s_failureCount << " checks failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "All tests passed" << std::endl;
+	return EXIT_SUCCESS;
+}
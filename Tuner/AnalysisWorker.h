@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "Semaphore.h"
+
+#if defined __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace winrt::Tuner::implementation
+{
+	struct AnalysisWorkerSettings
+	{
+		// Index of the CPU the worker is pinned to, negative value lets the OS decide (Linux only)
+		int cpuAffinity{ -1 };
+		// SCHED_FIFO priority (1-99) on Linux, THREAD_PRIORITY_* value on Windows, 0 keeps the default
+		int priority{ 0 };
+	};
+
+	// Long-lived thread running a job each time it is notified. Notifications arriving while
+	// the job runs are not lost, the job is simply run again, so it should drain all pending work.
+	class AnalysisWorker
+	{
+	public:
+
+		using Job		= std::function<void()>;
+		using Settings	= AnalysisWorkerSettings;
+
+	private:
+
+		Job					m_job;
+		Semaphore			m_semaphore;
+		std::atomic<bool>	m_running;
+		std::thread			m_thread;
+
+		// Returns false when the OS refused any of the settings (e.g. real-time priority without privileges)
+		static bool ApplySettings(const Settings& settings) noexcept
+		{
+			bool result = true;
+
+#if defined __linux__
+			if (settings.cpuAffinity >= 0)
+			{
+				cpu_set_t cpuSet;
+				CPU_ZERO(&cpuSet);
+				CPU_SET(settings.cpuAffinity, &cpuSet);
+				result &= pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+			}
+
+			if (settings.priority > 0)
+			{
+				sched_param param{};
+				param.sched_priority = settings.priority;
+				result &= pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+			}
+#elif defined _WIN32
+			if (settings.priority != 0)
+			{
+				result &= SetThreadPriority(GetCurrentThread(), settings.priority) != FALSE;
+			}
+#endif
+
+			return result;
+		}
+
+		void Run(Settings settings) noexcept
+		{
+			ApplySettings(settings);
+
+			while (true)
+			{
+				m_semaphore.Acquire();
+
+				if (!m_running.load(std::memory_order_acquire))
+				{
+					break;
+				}
+
+				m_job();
+			}
+		}
+
+	public:
+
+		AnalysisWorker() : m_job{ nullptr }, m_running{ false }
+		{
+		}
+
+		AnalysisWorker(AnalysisWorker&&)					= delete;
+		AnalysisWorker(const AnalysisWorker&)				= delete;
+		AnalysisWorker& operator=(AnalysisWorker&&)			= delete;
+		AnalysisWorker& operator=(const AnalysisWorker&)	= delete;
+
+		~AnalysisWorker()
+		{
+			Stop();
+		}
+
+		// Spawn the worker thread, job is run on it after every Notify()
+		void Start(Job job, Settings settings = Settings{})
+		{
+			if (m_running.exchange(true))
+			{
+				// Already started
+				return;
+			}
+
+			m_job		= std::move(job);
+			m_thread	= std::thread([this, settings]() { Run(settings); });
+		}
+
+		// Finish the job currently running, if any, and join the worker thread
+		void Stop() noexcept
+		{
+			if (!m_running.exchange(false))
+			{
+				return;
+			}
+
+			m_semaphore.Release();
+			m_thread.join();
+		}
+
+		// Wake the worker up, callable from a real-time thread
+		void Notify() noexcept
+		{
+			m_semaphore.Release();
+		}
+	};
+}
@@ -46,6 +46,8 @@ namespace winrt::Tuner::implementation
 				inputDevice = nodeCreation.DeviceInputNode();
 				// Input from the recording device is routed to frameOutputNode
 				inputDevice.AddOutgoingConnection(frameOutputNode);
+				// Start the thread analyzing recorded data
+				analysisWorker.Start([this]() { ConsumeSamples(); }, workerSettings);
 				co_return true;
 			}
 		}
@@ -67,55 +69,42 @@ namespace winrt::Tuner::implementation
 
 		WINRT_ASSERT(byte);
 
-		auto bufferSpaceLeft = std::distance(current, last);
-		
-		if (bufferSpaceLeft > buffer.Length())
+		const sample_t* samplesFirst	= reinterpret_cast<sample_t*>(byte);
+		const sample_t* samplesLast		= reinterpret_cast<sample_t*>(byte + buffer.Length());
+
+		// Overruns are counted by the ring buffer, capture goes on regardless
+		if (!sampleRingBuffer.Push(samplesFirst, samplesLast))
 		{
-			std::copy(reinterpret_cast<sample_t*>(byte), reinterpret_cast<sample_t*>(byte + buffer.Length()), current);
-			std::advance(current, buffer.Length() / sizeof(sample_t));
+			return;
 		}
-		else 
-		{
-			std::copy(reinterpret_cast<sample_t*>(byte), reinterpret_cast<sample_t*>(byte + bufferSpaceLeft), current);
 
-			RunCallbackAsync();
-			SwapBuffers();
+		// Consumer pops whole hops, so a hop is completed only when the write crosses a hop boundary.
+		// Quanta ending within the same hop do not wake the worker up again.
+		const size_t previousCount	= pushedSampleCount;
+		pushedSampleCount			+= static_cast<size_t>(samplesLast - samplesFirst);
+
+		if (previousCount / s_hopSize != pushedSampleCount / s_hopSize)
+		{
+			analysisWorker.Notify();
 		}
 	}
 
-	void AudioInput::SwapBuffers()
+	// Pass every complete hop from the ring buffer to the analysis window
+	void AudioInput::ConsumeSamples()
 	{
-		sampleBufferQueue.push(sampleBufferPtr);
-		sampleBufferPtr = sampleBufferQueue.front();
-		sampleBufferQueue.pop();
-		first = current = sampleBufferPtr->begin();
-		last = sampleBufferPtr->end();
+		while (sampleRingBuffer.Pop(hopBuffer.begin(), s_hopSize))
+		{
+			ProcessSamples(hopBuffer.begin(), hopBuffer.end());
+		}
 	}
 
 	AudioInput::AudioInput() : 
-		bufferFilledCallback	{ nullptr },
 		audioGraph				{ nullptr }, 
 		audioSettings			{ nullptr },
 		inputDevice				{ nullptr }, 
-		frameOutputNode			{ nullptr }
+		frameOutputNode			{ nullptr },
+		pushedSampleCount		{ 0U }
 	{
-		for (SampleBuffer& buffer : sampleBufferArray)
-		{
-			buffer.fill(0.0f);
-			sampleBufferQueue.push(&buffer);
-
-			/*
-				Push placeholder std::futures for async callback execution
-				for each sample buffer.
-			*/
-			asyncCallbackQueue.push(CallbackFuture());
-		}
-
-		// Prepare pointers and iterators for incoming data
-		sampleBufferPtr = sampleBufferQueue.front();
-		sampleBufferQueue.pop();
-		first = current = sampleBufferPtr->begin();
-		last = sampleBufferPtr->end();
 
 		// Fill audio settings
 		audioSettings = AudioGraphSettings(AudioRenderCategory::Media);
@@ -1,4 +1,7 @@
 #pragma once
+#include "AudioSource.h"
+#include "SampleRingBuffer.h"
+#include "AnalysisWorker.h"
 
 namespace winrt::Tuner::implementation
 {
@@ -7,46 +10,44 @@ namespace winrt::Tuner::implementation
 		virtual HRESULT __stdcall GetBuffer(unsigned char** value, unsigned int* capacity) = 0;
 	};
 
-	class AudioInput
+	// Audio source recording from the default input device through Windows::Media::Audio::AudioGraph
+	class AudioInput : public AudioSource
 	{
 	public:
 
-		static constexpr size_t s_audioBufferSize{ 131072U };
-		static constexpr size_t s_sampleBufferCount{ 4U };
+		// Capacity of the ring buffer between the audio graph and the analysis
+		static constexpr size_t s_ringBufferSize{ 65536U };
 
-		using sample_t				= float;
-		using SampleBuffer			= std::array<sample_t, s_audioBufferSize>;
-		using BufferIterator		= SampleBuffer::iterator;
-		using SampleBufferQueue		= std::queue<SampleBuffer*>;
-		using SampleBufferArray		= std::array<SampleBuffer, s_sampleBufferCount>;
-		using BufferFilledCallback	= std::function<void(BufferIterator first, BufferIterator last)>;
-		using CallbackFuture		= std::future<void>;
-		using AsyncCallbackQueue	= std::queue<CallbackFuture>;
+		static_assert(s_ringBufferSize >= 2U * s_hopSize, "Ring buffer must hold at least two hops.");
+
+		using HopBuffer			= std::array<sample_t, s_hopSize>;
+		using RingBuffer		= SampleRingBuffer<sample_t, s_ringBufferSize>;
+		using WorkerSettings	= AnalysisWorker::Settings;
 
 	private:
 
-		// BufferFilled event handler
-		BufferFilledCallback	bufferFilledCallback;
-		// Keep std::futures with asynchronously running callbacks in a queue form
-		AsyncCallbackQueue		asyncCallbackQueue;
+		WorkerSettings		workerSettings;
 
 		winrt::Windows::Media::Audio::AudioGraph			audioGraph;
 		winrt::Windows::Media::Audio::AudioGraphSettings	audioSettings;
 		winrt::Windows::Media::Audio::AudioDeviceInputNode	inputDevice;
 		winrt::Windows::Media::Audio::AudioFrameOutputNode	frameOutputNode;
 
-		SampleBufferArray	sampleBufferArray;
-		SampleBufferQueue	sampleBufferQueue;
-		SampleBuffer*		sampleBufferPtr;
+		// Samples recorded by the audio graph, waiting to be analyzed
+		RingBuffer			sampleRingBuffer;
+
+		// Number of samples pushed to the ring buffer, owned by the producer
+		size_t				pushedSampleCount;
+
+		// Hop taken from the ring buffer, owned by the consumer
+		HopBuffer			hopBuffer;
 
-		// Helper iterators
-		BufferIterator first;
-		BufferIterator last;
-		BufferIterator current;
+		// Thread consuming the ring buffer and running the callback, declared last
+		// so that it is joined before the buffers it uses are destroyed
+		AnalysisWorker		analysisWorker;
 
 		void audioGraph_QuantumStarted(winrt::Windows::Media::Audio::AudioGraph const& sender, winrt::Windows::Foundation::IInspectable const args);
-		void SwapBuffers();
-		void RunCallbackAsync();
+		void ConsumeSamples();
 
 	public:
 
@@ -55,42 +56,33 @@ namespace winrt::Tuner::implementation
 		// Get an instance of AudioInput class
 		winrt::Windows::Foundation::IAsyncOperation<bool> InitializeAsync();
 		// Start recording audio data
-		void Start() const;
+		void Start() override;
 		// Stop recording audio data
-		void Stop() const;
-		// Attach buffer filled callback
-		void BufferFilled(BufferFilledCallback bufferFilledCallback) noexcept;
+		void Stop() override;
+		// Set CPU affinity and priority of the analysis thread, must be called before InitializeAsync()
+		void SetWorkerSettings(const WorkerSettings& settings) noexcept;
 
 		// Get current sample rate
-		uint32_t GetSampleRate() const noexcept;
+		uint32_t GetSampleRate() const noexcept override;
 		// Get current bit depth
-		uint32_t GetBitDepth() const;
+		uint32_t GetBitDepth() const override;
+		// Get number of audio quanta dropped because analysis did not keep up
+		uint64_t GetOverrunCount() const noexcept;
 	};
 
-	inline void AudioInput::RunCallbackAsync()
-	{
-		asyncCallbackQueue.pop();
-		asyncCallbackQueue.push(std::async(
-			std::launch::async,
-			[this]() {
-				bufferFilledCallback(sampleBufferPtr->begin(), sampleBufferPtr->end());
-			})
-		);
-	}
-
-	inline void AudioInput::Start() const
+	inline void AudioInput::Start()
 	{
 		audioGraph.Start();
 	}
 
-	inline void AudioInput::Stop() const
+	inline void AudioInput::Stop()
 	{
 		audioGraph.Stop();
 	}
 
-	inline void AudioInput::BufferFilled(BufferFilledCallback callback) noexcept
+	inline void AudioInput::SetWorkerSettings(const WorkerSettings& settings) noexcept
 	{
-		this->bufferFilledCallback = callback;
+		workerSettings = settings;
 	}
 
 	// Get current sample rate
@@ -104,4 +96,10 @@ namespace winrt::Tuner::implementation
 	{
 		return inputDevice.EncodingProperties().BitsPerSample();
 	}
+
+	// Get number of audio quanta dropped because analysis did not keep up
+	inline uint64_t AudioInput::GetOverrunCount() const noexcept
+	{
+		return sampleRingBuffer.GetOverrunCount();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+namespace winrt::Tuner::implementation
+{
+	// Platform-neutral source of audio samples. Incoming samples are gathered into analysis
+	// windows of s_audioBufferSize samples, and every s_hopSize new samples the most recent
+	// window is passed in chronological order to the BufferFilled callback.
+	class AudioSource
+	{
+	public:
+
+		// Length of the analysis window passed to the BufferFilled callback, sub-bin
+		// interpolation in PitchAnalyzer keeps short windows accurate
+		static constexpr size_t s_audioBufferSize{ 8192U };
+		// Number of new samples between two consecutive analysis windows
+		static constexpr size_t s_hopSize{ 1024U };
+
+		static_assert(s_hopSize > 0U && s_hopSize <= s_audioBufferSize, "Hop size must be in range (0, s_audioBufferSize].");
+
+		using sample_t				= float;
+		using SampleBuffer			= std::array<sample_t, s_audioBufferSize>;
+		using BufferIterator		= sample_t*;
+		using BufferFilledCallback	= std::function<void(BufferIterator first, BufferIterator last)>;
+
+	private:
+
+		// BufferFilled event handler
+		BufferFilledCallback	bufferFilledCallback;
+
+		// Most recent s_audioBufferSize samples in chronological order
+		SampleBuffer			frameBuffer;
+		// Number of samples of the current hop already written to the end of frameBuffer
+		size_t					hopPosition;
+
+	protected:
+
+		AudioSource() : bufferFilledCallback{ nullptr }, hopPosition{ 0U }
+		{
+			frameBuffer.fill(0.0f);
+		}
+
+		// Append samples to the analysis window and run the callback for every completed hop.
+		// Must always be called from the same thread, the callback runs on it.
+		template<typename _InIt>
+		void ProcessSamples(_InIt first, _InIt last);
+
+		// Forget all samples received so far
+		void ResetFrame() noexcept
+		{
+			frameBuffer.fill(0.0f);
+			hopPosition = 0U;
+		}
+
+	public:
+
+		virtual ~AudioSource() = default;
+
+		AudioSource(AudioSource&&)					= delete;
+		AudioSource(const AudioSource&)				= delete;
+		AudioSource& operator=(AudioSource&&)		= delete;
+		AudioSource& operator=(const AudioSource&)	= delete;
+
+		// Start producing audio data
+		virtual void Start() = 0;
+		// Stop producing audio data
+		virtual void Stop() = 0;
+		// Get current sample rate
+		virtual uint32_t GetSampleRate() const = 0;
+		// Get current bit depth
+		virtual uint32_t GetBitDepth() const = 0;
+
+		// Attach buffer filled callback
+		void BufferFilled(BufferFilledCallback callback) noexcept
+		{
+			bufferFilledCallback = callback;
+		}
+	};
+
+	template<typename _InIt>
+	inline void AudioSource::ProcessSamples(_InIt first, _InIt last)
+	{
+		sample_t* frameFirst	= frameBuffer.data();
+		sample_t* frameLast		= frameFirst + frameBuffer.size();
+		sample_t* hopFirst		= frameLast - s_hopSize;
+
+		while (first != last)
+		{
+			// Make room for a new hop by discarding the oldest one
+			if (hopPosition == 0U)
+			{
+				std::move(std::next(frameFirst, s_hopSize), frameLast, frameFirst);
+			}
+
+			const size_t samplesLeft	= static_cast<size_t>(std::distance(first, last));
+			const size_t count			= std::min(samplesLeft, s_hopSize - hopPosition);
+
+			auto middle = std::next(first, count);
+			std::copy(first, middle, std::next(hopFirst, hopPosition));
+			first = middle;
+			hopPosition += count;
+
+			if (hopPosition == s_hopSize)
+			{
+				hopPosition = 0U;
+
+				if (bufferFilledCallback)
+				{
+					bufferFilledCallback(frameFirst, frameLast);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include "PitchAnalyzerTraits.h"
+
+namespace winrt::Tuner::implementation
+{
+	// Counters of a LatestValueMailbox
+	struct MailboxStatistics
+	{
+		// Values written by the producer
+		uint64_t published;
+		// Values read by the consumer
+		uint64_t consumed;
+		// Values overwritten by a newer one before the consumer read them
+		uint64_t dropped;
+		// Reads that skipped over at least one dropped value
+		uint64_t coalesced;
+	};
+
+	// Wait-free single-producer/single-consumer mailbox holding only the latest value (triple buffer).
+	// Producer writes to its own slot and swaps it with the shared one, consumer swaps its slot with
+	// the shared one when a new value is there, so neither of them ever waits or copies the value twice.
+	// Consumer either polls TryRead() at its own rate or reacts to the notification, which is sent
+	// once per batch of values published since the last read.
+	template<typename _Ty>
+	class LatestValueMailbox
+	{
+		static_assert(std::is_default_constructible_v<_Ty> && std::is_copy_assignable_v<_Ty>, "Value type must be default constructible and copy assignable.");
+
+		using Notification = std::function<void()>;
+
+		// Slot holding a value and the number it was published with
+		struct alignas(s_cacheLineSize) Slot
+		{
+			_Ty			value;
+			uint64_t	sequence;
+		};
+
+		// Index of the shared slot, with the flag set when it holds a value the consumer has not seen
+		static constexpr uint8_t s_indexMask{ 0x3U };
+		static constexpr uint8_t s_newValueFlag{ 0x4U };
+
+		std::array<Slot, 3U>	m_slots;
+
+		alignas(s_cacheLineSize) std::atomic<uint8_t>	m_shared;
+
+		// Producer side
+		alignas(s_cacheLineSize) uint8_t				m_producerSlot;
+		std::atomic<uint64_t>							m_publishedCount;
+		Notification									m_notification;
+
+		// Consumer side
+		alignas(s_cacheLineSize) uint8_t				m_consumerSlot;
+		uint64_t										m_lastSequence;
+		std::atomic<uint64_t>							m_consumedCount;
+		std::atomic<uint64_t>							m_droppedCount;
+		std::atomic<uint64_t>							m_coalescedCount;
+
+	public:
+
+		LatestValueMailbox() :
+			m_slots				{},
+			m_shared			{ 1U },
+			m_producerSlot		{ 0U },
+			m_publishedCount	{ 0U },
+			m_consumerSlot		{ 2U },
+			m_lastSequence		{ 0U },
+			m_consumedCount		{ 0U },
+			m_droppedCount		{ 0U },
+			m_coalescedCount	{ 0U }
+		{
+		}
+
+		LatestValueMailbox(LatestValueMailbox&&)					= delete;
+		LatestValueMailbox(const LatestValueMailbox&)				= delete;
+		LatestValueMailbox& operator=(LatestValueMailbox&&)			= delete;
+		LatestValueMailbox& operator=(const LatestValueMailbox&)	= delete;
+
+		// Attach function called by the producer when a value is published and the previous one
+		// has already been read. Must be set before the producer starts.
+		void SetNotification(Notification notification)
+		{
+			m_notification = std::move(notification);
+		}
+
+		// Producer side. Replaces the value not read yet, if any.
+		void Publish(const _Ty& value)
+		{
+			const uint64_t sequence = m_publishedCount.load(std::memory_order_relaxed) + 1U;
+
+			Slot& slot		= m_slots[m_producerSlot];
+			slot.value		= value;
+			slot.sequence	= sequence;
+
+			const uint8_t previous = m_shared.exchange(static_cast<uint8_t>(m_producerSlot | s_newValueFlag), std::memory_order_acq_rel);
+			m_producerSlot = previous & s_indexMask;
+			m_publishedCount.store(sequence, std::memory_order_relaxed);
+
+			// Consumer already knows about the value it has not read yet
+			if (!(previous & s_newValueFlag) && m_notification)
+			{
+				m_notification();
+			}
+		}
+
+		// Consumer side. Copies the latest value to dest if one was published since the last read.
+		bool TryRead(_Ty& dest)
+		{
+			if (!(m_shared.load(std::memory_order_relaxed) & s_newValueFlag))
+			{
+				return false;
+			}
+
+			const uint8_t previous	= m_shared.exchange(m_consumerSlot, std::memory_order_acq_rel);
+			m_consumerSlot			= previous & s_indexMask;
+
+			const Slot& slot		= m_slots[m_consumerSlot];
+			const uint64_t skipped	= slot.sequence - m_lastSequence - 1U;
+			m_lastSequence			= slot.sequence;
+
+			if (skipped > 0U)
+			{
+				m_droppedCount.fetch_add(skipped, std::memory_order_relaxed);
+				m_coalescedCount.fetch_add(1U, std::memory_order_relaxed);
+			}
+
+			m_consumedCount.fetch_add(1U, std::memory_order_relaxed);
+			dest = slot.value;
+			return true;
+		}
+
+		// Check if a value was published since the last read, may be called from any thread
+		bool HasNewValue() const noexcept
+		{
+			return m_shared.load(std::memory_order_acquire) & s_newValueFlag;
+		}
+
+		// Counters, may be read from any thread. Values published but not read yet
+		// are neither consumed nor dropped.
+		MailboxStatistics GetStatistics() const noexcept
+		{
+			return {
+				m_publishedCount.load(std::memory_order_relaxed),
+				m_consumedCount.load(std::memory_order_relaxed),
+				m_droppedCount.load(std::memory_order_relaxed),
+				m_coalescedCount.load(std::memory_order_relaxed)
+			};
+		}
+	};
+}
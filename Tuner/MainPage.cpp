@@ -77,11 +77,15 @@ namespace winrt::Tuner::implementation
 		}
 
 		m_pitchAnalyzer.SetSamplingFrequency(m_audioInput.GetSampleRate());
+		// Consecutive windows overlap, which allows the phase vocoder refinement
+		m_pitchAnalyzer.SetHopSize(AudioInput::s_hopSize);
 
-		// Set sound analyzed callback
-		m_pitchAnalyzer.SoundAnalyzed([this](const std::string& note, float frequency, float cents) { 
-			SoundAnalyzed_Callback(note, frequency, cents); 
+		// Results are shown as fast as the UI thread keeps up, it is notified once per
+		// batch of results and always reads the latest one
+		m_resultMailbox.SetNotification([this]() { 
+			SoundAnalyzed_Callback(); 
 		});
+		m_pitchAnalyzer.PublishResults(&m_resultMailbox);
 
 		co_await m_pitchAnalyzer.InitializeAsync();
 
@@ -95,12 +99,21 @@ namespace winrt::Tuner::implementation
 		co_return true;
 	}
 
-	IAsyncAction MainPage::SoundAnalyzed_Callback(const std::string& note, float frequency, float cents)
+	IAsyncAction MainPage::SoundAnalyzed_Callback()
 	{
 		co_await resume_foreground(TuningScreen().Dispatcher());
 
+		PitchAnalysisResult result;
+
+		if (!m_resultMailbox.TryRead(result))
+		{
+			co_return;
+		}
+
+		const float cents = result.cents;
+
 		// Put the nearest note on the screen
-		Note_TextBlock().Text(to_hstring(note));
+		Note_TextBlock().Text(to_hstring(result.GetNoteName()) + to_hstring(result.octave));
 
 		// Check if range is correct
 		WINRT_ASSERT(std::abs(cents) <= 50.0f);
@@ -9,7 +9,10 @@ namespace winrt::Tuner::implementation
     struct MainPage : MainPageT<MainPage>
     {
         static constexpr uint32_t s_audioBufferSize = AudioInput::s_audioBufferSize;
-        static constexpr uint32_t s_filterSize = 4096U;
+        // Input is decimated before the analysis, which needs only the band up to s_maxFrequency
+        static constexpr uint32_t s_decimationFactor = 8U;
+        // Taps at the decimated sampling frequency, as long in time as 4096 taps at the full rate
+        static constexpr uint32_t s_filterSize = 512U;
 
         static constexpr float s_baseNoteFrequency = 440.0f;
 
@@ -19,7 +22,7 @@ namespace winrt::Tuner::implementation
 
         using sample_t              = AudioInput::sample_t;
         using DotArray              = std::array<winrt::Windows::UI::Xaml::Shapes::Ellipse, 13>;
-        using PitchAnalyzer         = PitchAnalyzer<s_audioBufferSize, s_filterSize, sample_t>;
+        using PitchAnalyzer         = PitchAnalyzer<s_audioBufferSize, s_filterSize, sample_t, HarmonicProductSpectrumDetector, s_decimationFactor>;
 
         enum class MainPageState {
             Loading,
@@ -35,6 +38,7 @@ namespace winrt::Tuner::implementation
             static winrt::Windows::UI::Xaml::Media::SolidColorBrush Green() noexcept;
         };
 
+        PitchAnalyzer::ResultMailbox m_resultMailbox;
         AudioInput m_audioInput;
 		PitchAnalyzer m_pitchAnalyzer;
         DotArray m_dotArray;
@@ -50,9 +54,10 @@ namespace winrt::Tuner::implementation
         winrt::Windows::Foundation::IAsyncOperation<bool> InitializeFunctionality();
 
         /*
-        *	Function serves as a callback to the PitchAnalyzer objects' SoundAnalyzed event.
+        *	Function serves as a notification of the result mailbox PitchAnalyzer publishes to.
+        *	Shows the latest result on the UI thread.
         */
-        winrt::Windows::Foundation::IAsyncAction SoundAnalyzed_Callback(const std::string& note, float frequency, float cents);
+        winrt::Windows::Foundation::IAsyncAction SoundAnalyzed_Callback();
 
         /*
         *	Set currently visible page depending on the current application state.
@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cmath>
+
+namespace winrt::Tuner::implementation
+{
+	// Names of the notes of an octave, starting from C
+	inline constexpr std::array<const char*, 12> s_noteNames{ "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+
+	// MIDI note number of A4, the note tuned to the base tone frequency
+	inline constexpr int s_baseToneMidiNote{ 69 };
+
+	// Open strings of a guitar in standard tuning, E2 A2 D3 G3 B3 E4
+	inline constexpr std::array<int, 6> s_standardGuitarTuning{ 40, 45, 50, 55, 59, 64 };
+
+	// Result of a single pitch analysis
+	struct PitchAnalysisResult
+	{
+		// MIDI note number of the nearest note, 69 for A4
+		int		midiNote;
+		// Octave in scientific pitch notation, 4 for A4
+		int		octave;
+		// Detected frequency in Hz
+		float	frequency;
+		// Deviation from the nearest note, in range [-50, 50]
+		float	cents;
+		// How well the signal matches the detected pitch, in range [0, 1]
+		float	confidence;
+
+		// Name of the nearest note without the octave, e.g. "C#"
+		const char* GetNoteName() const noexcept
+		{
+			return s_noteNames[static_cast<size_t>((midiNote % 12 + 12) % 12)];
+		}
+	};
+
+	// Find the nearest note of the equal temperament scale in which A4 is tuned to baseToneFrequency.
+	// Frequency must be positive, confidence of the result is left 0.
+	inline PitchAnalysisResult GetNearestNote(float frequency, float baseToneFrequency) noexcept
+	{
+		const float semitones	= 12.0f * std::log2(frequency / baseToneFrequency);
+		const float nearest		= std::round(semitones);
+		const int midiNote		= s_baseToneMidiNote + static_cast<int>(nearest);
+
+		// MIDI note 0 is C-1, octaves of negative notes are rounded down
+		const int octave		= (midiNote >= 0 ? midiNote / 12 : (midiNote - 11) / 12) - 1;
+
+		return { midiNote, octave, frequency, 100.0f * (semitones - nearest), 0.0f };
+	}
+
+	// Frequency of the note of the equal temperament scale in which A4 is tuned to baseToneFrequency
+	inline float GetNoteFrequency(int midiNote, float baseToneFrequency) noexcept
+	{
+		return baseToneFrequency * std::exp2(static_cast<float>(midiNote - s_baseToneMidiNote) / 12.0f);
+	}
+
+	// Frame of a pitch track of a recording
+	struct PitchTrackPoint
+	{
+		// Time of the center of the analyzed window, in seconds from the start of the recording
+		double				time;
+		// Zero-initialized if no pitch was found in the requested range
+		PitchAnalysisResult	pitch;
+	};
+}
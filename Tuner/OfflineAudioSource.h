@@ -0,0 +1,122 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "AudioSource.h"
+
+namespace winrt::Tuner::implementation
+{
+	// Base class for sources replaying prerecorded or generated samples. Replay is not paced
+	// to the sample rate, samples are delivered as fast as the callback consumes them, so
+	// the analysis throughput can be measured.
+	class OfflineAudioSource : public AudioSource
+	{
+	public:
+
+		struct ReplayStatistics
+		{
+			// Number of samples delivered during the last replay
+			uint64_t	sampleCount{ 0U };
+			// Number of analysis windows emitted during the last replay once a whole window was replayed
+			uint64_t	frameCount{ 0U };
+			// Number of analysis windows emitted before, still holding zeros from before the replay
+			uint64_t	warmUpFrameCount{ 0U };
+			// Wall-clock duration of the last replay
+			double		elapsedSeconds{ 0.0 };
+			// Duration of the replayed audio divided by the time it took to replay it
+			double		realTimeFactor{ 0.0 };
+		};
+
+	private:
+
+		using ReadBuffer = std::array<sample_t, s_hopSize>;
+
+		// Windows emitted before the first one made of replayed samples only
+		static constexpr uint64_t s_warmUpFrameCount{ (s_audioBufferSize - 1U) / s_hopSize };
+
+		ReadBuffer			readBuffer;
+		ReplayStatistics	statistics;
+		uint32_t			sampleRate;
+		std::atomic<bool>	stopRequested;
+
+	protected:
+
+		explicit OfflineAudioSource(uint32_t sampleRate) : sampleRate{ sampleRate }, stopRequested{ false }
+		{
+			readBuffer.fill(0.0f);
+		}
+
+		void SetSampleRate(uint32_t newSampleRate) noexcept
+		{
+			sampleRate = newSampleRate;
+		}
+
+		// Read up to count samples to dest, return the number of samples read, 0 at the end of data
+		virtual size_t ReadSamples(sample_t* dest, size_t count) = 0;
+		// Move back to the first sample
+		virtual void Rewind() = 0;
+
+	public:
+
+		// Replay all samples from the beginning. Runs synchronously on the calling thread, which
+		// is also the thread the callback is called from. Returns at the end of data or after Stop().
+		void Start() override;
+
+		// Stop the replay, may be called from the BufferFilled callback
+		void Stop() override
+		{
+			stopRequested.store(true, std::memory_order_relaxed);
+		}
+
+		// Get current sample rate
+		uint32_t GetSampleRate() const noexcept override
+		{
+			return sampleRate;
+		}
+
+		// Get throughput of the last replay
+		const ReplayStatistics& GetStatistics() const noexcept
+		{
+			return statistics;
+		}
+	};
+
+	inline void OfflineAudioSource::Start()
+	{
+		using clock_t = std::chrono::steady_clock;
+
+		stopRequested.store(false, std::memory_order_relaxed);
+		statistics = ReplayStatistics{};
+
+		Rewind();
+		ResetFrame();
+
+		const auto startTime = clock_t::now();
+
+		while (!stopRequested.load(std::memory_order_relaxed))
+		{
+			const size_t count = ReadSamples(readBuffer.data(), readBuffer.size());
+
+			if (count == 0U)
+			{
+				break;
+			}
+
+			ProcessSamples(readBuffer.begin(), std::next(readBuffer.begin(), count));
+			statistics.sampleCount += count;
+		}
+
+		const std::chrono::duration<double> elapsed = clock_t::now() - startTime;
+
+		const uint64_t emittedFrameCount = statistics.sampleCount / s_hopSize;
+
+		statistics.warmUpFrameCount	= std::min(emittedFrameCount, s_warmUpFrameCount);
+		statistics.frameCount		= emittedFrameCount - statistics.warmUpFrameCount;
+		statistics.elapsedSeconds	= elapsed.count();
+
+		if (statistics.elapsedSeconds > 0.0 && sampleRate > 0U)
+		{
+			statistics.realTimeFactor = static_cast<double>(statistics.sampleCount) / static_cast<double>(sampleRate) / statistics.elapsedSeconds;
+		}
+	}
+}
@@ -1,8 +1,37 @@
 #pragma once
+#if __has_include(<winrt/Windows.Storage.h>)
+#define DSP_WINRT_STORAGE
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Storage.h>
+#endif
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 #include "PitchAnalyzerTraits.h"
+#include "ChirpZTransform.h"
 #include "FilterGenerator.h"
+#include "FilterCache.h"
+#include "PolyphaseDecimator.h"
+#include "SlidingDFT.h"
 #include "DSPMath.h"
 #include "FFTPlan.h"
+#include "WisdomStore.h"
+#include "PitchDetectors.h"
+#include "NoteLookup.h"
+#include "LatestValueMailbox.h"
 
 // Enable/disable Matlab code generation
 // If defined, debugging will stop on every 
@@ -14,6 +43,36 @@
 #undef CREATE_MATLAB_PLOTS
 #endif
 
+// Matlab files are written to the app's storage folder
+#if !defined DSP_WINRT_STORAGE && defined CREATE_MATLAB_PLOTS
+#undef CREATE_MATLAB_PLOTS
+#endif
+
+// Enable/disable measuring time spent in each stage of Analyze(),
+// results are available through GetStageTimings()
+
+//#define PROFILE_ANALYSIS_STAGES
+
+#ifdef PROFILE_ANALYSIS_STAGES
+#include <chrono>
+#define PROFILE_STAGE_BEGIN() auto profiledStageStart = std::chrono::steady_clock::now()
+#define PROFILE_STAGE_END(stage) \
+	{ \
+		const auto profiledStageEnd = std::chrono::steady_clock::now(); \
+		m_stageTimings.stage = profiledStageEnd - profiledStageStart; \
+		profiledStageStart = profiledStageEnd; \
+	}
+#else
+#define PROFILE_STAGE_BEGIN()
+#define PROFILE_STAGE_END(stage)
+#endif
+
+// Allow building outside of C++/WinRT, e.g. for tests and benchmarks
+#ifndef WINRT_ASSERT
+#include <cassert>
+#define WINRT_ASSERT(expression) assert(expression)
+#endif
+
 #ifdef max
 #undef max
 #endif
@@ -23,45 +82,211 @@
 
 namespace winrt::Tuner::implementation
 {
-	template<size_t s_audioBufferSize, size_t s_filterSize, typename sample_t = float>
+	// Audio buffer may be decimated before the analysis by s_decimationFactor. Decimator passes the band up to
+	// a quarter of the decimated sampling frequency, the maximum frequency must stay below it, e.g. 1378 Hz when
+	// 44.1 kHz input is decimated by 8. Filter size is given at the decimated sampling frequency.
+	template<size_t s_audioBufferSize, size_t s_filterSize, typename sample_t = float, template<typename, size_t, size_t> class Detector = HarmonicProductSpectrumDetector, size_t s_decimationFactor = 1U>
 	class PitchAnalyzer
 	{
 		static_assert(Is_positive_power_of_2(s_audioBufferSize), "Audio buffer size must be a power of 2.");
 		static_assert(Is_positive_power_of_2(s_filterSize), "Filter size must be a power of 2.");
+		static_assert(Is_positive_power_of_2(s_decimationFactor) && s_decimationFactor < s_audioBufferSize, "Decimation factor must be a power of 2 smaller than the audio buffer size.");
+
+		// FFTW requires arrays passed to a plan to have the alignment of the arrays it was created for
+		static constexpr size_t s_bufferAlignment		= 64U;
+		// Filters of the most recently used frequency ranges kept for switching back to them
+		static constexpr size_t s_filterCacheCapacity	= 8U;
+		static constexpr DSP::WindowGenerator::WindowType s_filterWindowType = DSP::WindowGenerator::WindowType::BlackmanHarris;
+
+	public:
+
+		// Length of the analyzed window after decimation
+		static constexpr size_t s_analysisBufferSize	= s_audioBufferSize / s_decimationFactor;
+		// Length of the filtered signal, the shortest FFT computing the linear convolution
+		static constexpr size_t s_filteredSignalSize	= s_analysisBufferSize + s_filterSize - 1U;
+		// Length of the real FFT input, the audio buffer zero-padded for linear filtering up to
+		// the next size FFTW transforms fast
+		static constexpr size_t s_fftSize				= DSP::NextFastFFTSize(s_filteredSignalSize);
+
+	private:
+
+		static constexpr size_t s_fftResultSize			= s_fftSize / 2U + 1U;
+		// Bins of the zoomed spectrum evaluated around the detected peak, spanning an FFT bin on each side of it
+		static constexpr size_t s_zoomBinCount			= 64U;
+		static constexpr double s_zoomBinSpacing		= 2.0 / static_cast<double>(s_fftSize * (s_zoomBinCount - 1U));
+
+	public:
+
+		using Detector_t = Detector<sample_t, s_analysisBufferSize, s_fftSize>;
+
+	private:
+
+		static constexpr bool s_decimates = s_decimationFactor > 1U;
+
+		// Stages of the analysis required by the detector
+		static constexpr bool s_usesSpectrum				= Detector_t::s_usesSpectrum;
+		static constexpr bool s_usesFilteredPowerSpectrum	= Detector_t::s_usesFilteredPowerSpectrum;
+
+		static_assert(s_usesSpectrum || !s_usesFilteredPowerSpectrum, "Filtered power spectrum is computed from the spectrum.");
+
+		// Placeholder of buffers not used by the detector
+		struct UnusedBuffer
+		{
+		};
 
-		static constexpr size_t s_filteredSignalSize	= s_audioBufferSize + s_filterSize - 1U;
-		static constexpr size_t s_fftResultSize			= s_filteredSignalSize / 2U + 1U;
+		template<bool s_used, typename _Ty>
+		using Optional_buffer = std::conditional_t<s_used, _Ty, UnusedBuffer>;
 
 		// Type aliases
 		using complex_t				= std::complex<sample_t>;
-		using SampleBuffer			= std::array<sample_t, s_filteredSignalSize>;
-		using WindowCoeffBuffer		= std::array<sample_t, s_audioBufferSize>;
+		using SampleBuffer			= std::array<sample_t, s_fftSize>;
+		using FilterCoeffBuffer		= std::array<sample_t, s_filterSize>;
+		using WindowCoeffBuffer		= std::array<sample_t, s_analysisBufferSize>;
+		using AnalysisBuffer		= std::array<sample_t, s_analysisBufferSize>;
 		using FFTResultBuffer		= std::array<complex_t, s_fftResultSize>;
-		using NoteFrequenciesMap	= std::map<sample_t, std::string>;
-		using SoundAnalyzedCallback = std::function<void(const std::string& note, float frequency, float cents)>;
+		using PowerSpectrumBuffer	= std::array<sample_t, s_fftResultSize>;
+		using ZoomSpectrumBuffer	= std::array<complex_t, s_zoomBinCount>;
+		using ZoomTransform_t		= DSP::ChirpZTransform<sample_t>;
+		using SlidingDFT_t			= DSP::SlidingDFT<sample_t>;
+		using SoundAnalyzedCallback = std::function<void(PitchAnalysisResult result)>;
+
+	public:
+
+		using ResultMailbox			= LatestValueMailbox<PitchAnalysisResult>;
+
+	private:
+
+		// Data computed during initialization and only read by the analysis, shared with the workers
+		// of AnalyzeRecording()
+		struct SharedState
+		{
+			// Window coefficients
+			Optional_buffer<s_usesSpectrum, WindowCoeffBuffer>	windowCoeffBuffer;
+
+			// Forward FFT of the audio buffer, created only if the detector uses the spectrum.
+			// Executed on the buffers of each analyzer, which have the same alignment.
+			DSP::FFTPlan<sample_t>	fftPlan;
+		};
+
+		// FIR band-pass filter of a frequency range, immutable once designed and shared by the analyzer,
+		// its workers and the filter cache
+		struct FilterResponse
+		{
+			FilterCoeffBuffer	coefficients;
+			// Squared magnitude of the filter frequency response
+			PowerSpectrumBuffer	powerResponse;
+		};
+
+		// Zero-padded filter and its spectrum, of the FFT size
+		struct FilterDesignBuffers
+		{
+			alignas(s_bufferAlignment) SampleBuffer		input;
+			alignas(s_bufferAlignment) FFTResultBuffer	output;
+		};
+
+		// Frequency range requested by the setters, with its filter once it is available
+		struct RangeRequest
+		{
+			float									minFrequency;
+			float									maxFrequency;
+			std::shared_ptr<const FilterResponse>	filter;
+		};
+
+	public:
+
+#ifdef PROFILE_ANALYSIS_STAGES
+		// Time spent in each stage of the last Analyze() call, stages not used by the detector stay 0
+		struct StageTimings
+		{
+			std::chrono::nanoseconds decimation{ 0 };
+			std::chrono::nanoseconds window{ 0 };
+			std::chrono::nanoseconds fft{ 0 };
+			// Filtering fused with the power spectrum computation
+			std::chrono::nanoseconds filter{ 0 };
+			std::chrono::nanoseconds detection{ 0 };
+			std::chrono::nanoseconds zoom{ 0 };
+			std::chrono::nanoseconds noteLookup{ 0 };
+			// Frames of AnalyzeStream(): sliding DFT updates since the previous frame and its spectrum,
+			// instead of decimation, window and fft
+			std::chrono::nanoseconds slidingDFT{ 0 };
+		};
+#endif
+
+		// How Initialize() creates the forward FFT plan when no wisdom is available
+		enum class FFTPlanning
+		{
+			// Block until the optimal plan is measured
+			blocking,
+			// Start immediately with an estimated plan and measure the optimal one in background,
+			// it replaces the estimated one between two Analyze() calls
+			background
+		};
 
-		// Struct holding the result of each, returned from GetNote() function.
-		struct PitchAnalysisResult
+		// Origin of the forward FFT plan in use
+		enum class FFTPlanSource
 		{
-			const std::string& note;
-			const float cents;
+			none,
+			wisdom,
+			estimate,
+			measure
 		};
 
+		struct FFTPlanStatistics
+		{
+			FFTPlanSource				source;
+			// Floating point operations of one transform of the plan in use, as counted by FFTW
+			double						flops;
+			// Time spent creating the plan used first
+			std::chrono::nanoseconds	planningTime;
+			// Time spent measuring the optimal plan in background, 0 until it is ready
+			std::chrono::nanoseconds	backgroundPlanningTime;
+			// Measured plan is not in use yet
+			bool						backgroundPlanningPending;
+		};
+
+	private:
+
 		// Callback function called when sound is analyzed
 		SoundAnalyzedCallback	m_soundAnalyzedCallback;
 
-		FFTResultBuffer			m_fftResult;
+		// Mailbox the latest result is published to, not owned
+		ResultMailbox*			m_resultMailbox;
+
+		// Low-pass filter decimating the audio buffer and the decimated signal
+		Optional_buffer<s_decimates, DSP::PolyphaseDecimator<sample_t>>	m_decimator;
+		alignas(s_bufferAlignment) Optional_buffer<s_decimates, AnalysisBuffer>		m_decimatedInput;
+
+		// Windowed input signal, zero-padded to the FFT size
+		alignas(s_bufferAlignment) Optional_buffer<s_usesSpectrum, SampleBuffer>		m_fftInput;
+		alignas(s_bufferAlignment) Optional_buffer<s_usesSpectrum, FFTResultBuffer>	m_fftResult;
 
-		// FIR filter parameters
-		SampleBuffer			m_filterCoeff;
-		FFTResultBuffer			m_filterFreqResponse;
+		// Power spectrum of the filtered signal, computed up to the highest bin in the requested range
+		Optional_buffer<s_usesFilteredPowerSpectrum, PowerSpectrumBuffer>	m_powerSpectrum;
 
-		// Window coefficients
-		WindowCoeffBuffer		m_windowCoeffBuffer;
+		// Chirp-z transform of the windowed signal over a narrow band around the detected peak
+		Optional_buffer<s_usesSpectrum, ZoomTransform_t>		m_zoomTransform;
+		Optional_buffer<s_usesSpectrum, ZoomSpectrumBuffer>	m_zoomSpectrum;
 
-		// Requested frequency range
-		const float				m_minFrequency;
-		const float				m_maxFrequency;
+		// Spectrum of the newest window of the stream passed to AnalyzeStream() and number of samples
+		// streamed since its last frame
+		Optional_buffer<s_usesSpectrum, SlidingDFT_t>		m_slidingDFT;
+		size_t												m_streamedSamples;
+
+		// Filter, window and FFT plan
+		std::shared_ptr<SharedState>	m_shared;
+
+		// Pitch detector
+		Detector_t				m_detector;
+
+		// Number of samples between the starts of consecutive frames, 0 if unknown
+		size_t					m_hopSize;
+
+		// Refine the detected frequency from the zoomed spectrum
+		bool					m_zoomRefinement;
+
+		// Frequency range in use, owned by the analysis thread after initialization
+		float					m_minFrequency;
+		float					m_maxFrequency;
 
 		// Frequency of the base tone
 		float					m_baseToneFrequency;
@@ -69,20 +294,69 @@ namespace winrt::Tuner::implementation
 		// Sampling frequency
 		float					m_samplingFrequency;
 
-		DSP::FFTPlan<sample_t>	m_fftPlan;
+		bool					m_initialized;
 
-		// Frequencies and notes that represents them are stored in std::map<float, std::string>
-		NoteFrequenciesMap		m_noteFrequenciesMap;
+		// Settings passed to the detector changed since it last applied them
+		std::atomic<bool>		m_detectorSettingsChanged;
 
-		bool					m_initialized;
+#ifdef PROFILE_ANALYSIS_STAGES
+		StageTimings			m_stageTimings;
+		// Time spent in sliding DFT updates since the last frame of the stream
+		std::chrono::nanoseconds	m_slidingUpdateTime{ 0 };
+#endif
+
+		// Filter of the frequency range in use
+		std::shared_ptr<const FilterResponse>	m_filter;
+
+		// Latest range requested by the setters, taken over by the analysis thread between frames
+		// when the flag is set. Mutex also guards the cache and the design task state.
+		std::mutex								m_rangeMutex;
+		RangeRequest							m_requestedRange;
+		std::atomic<bool>						m_requestedRangeReady{ false };
+
+		// Filters of recently used ranges and the plan and buffers new ones are designed with,
+		// created by Initialize() and used by one thread at a time
+		DSP::FilterCache<FilterResponse>		m_filterCache{ s_filterCacheCapacity };
+		std::unique_ptr<FilterDesignBuffers>	m_filterDesignBuffers;
+		DSP::FFTPlan<sample_t>					m_filterFFTPlan;
+		bool									m_filterDesignRunning{ false };
+
+		// Statistics of the forward FFT plan, may be read from any thread
+		std::atomic<FFTPlanSource>				m_fftPlanSource{ FFTPlanSource::none };
+		std::atomic<double>						m_fftPlanFlops{ 0.0 };
+		std::atomic<std::chrono::nanoseconds>	m_planningTime{ std::chrono::nanoseconds{ 0 } };
+		std::atomic<std::chrono::nanoseconds>	m_backgroundPlanningTime{ std::chrono::nanoseconds{ 0 } };
+		std::atomic<bool>						m_backgroundPlanningPending{ false };
+
+		// Plan measured in background, handed over to the analysis thread when the flag is set
+		DSP::FFTPlan<sample_t>					m_measuredFFTPlan;
+		double									m_measuredFFTPlanFlops{ 0.0 };
+		std::atomic<bool>						m_measuredFFTPlanReady{ false };
+
+		// Zoom transform created in background when refinement is enabled after initialization,
+		// handed over to the analysis thread when the flag is set
+		Optional_buffer<s_usesSpectrum, ZoomTransform_t>	m_createdZoomTransform;
+		std::atomic<bool>									m_createdZoomTransformReady{ false };
+
+		// Tasks are declared last, so the destructor waits for them before anything they use is destroyed
+		std::future<void>						m_planningTask;
+		std::future<void>						m_zoomPlanningTask;
+		std::future<void>						m_filterDesignTask;
 
 	public:
 
 		PitchAnalyzer(float minFrequency, float maxFrequency, float baseToneFrequency = 0.0f, float samplingFrequency = 0.0f) :
-			m_baseToneFrequency	{ baseToneFrequency }, 
-			m_minFrequency		{ minFrequency }, 
-			m_maxFrequency		{ maxFrequency }, 
-			m_initialized		{ false }
+			m_resultMailbox				{ nullptr },
+			m_streamedSamples			{ 0U },
+			m_shared					{ std::make_shared<SharedState>() },
+			m_hopSize					{ 0U },
+			m_zoomRefinement			{ false },
+			m_minFrequency				{ minFrequency }, 
+			m_maxFrequency				{ maxFrequency }, 
+			m_baseToneFrequency			{ baseToneFrequency }, 
+			m_initialized				{ false },
+			m_detectorSettingsChanged	{ false },
+			m_requestedRange			{ minFrequency, maxFrequency, nullptr }
 		{
 			// Allow for initializing values of sampling frequency and base note frequency later
 			
@@ -96,9 +370,22 @@ namespace winrt::Tuner::implementation
 				SetBaseToneFrequency(baseToneFrequency);
 			}
 
+			if constexpr (s_decimates)
+			{
+				m_decimator = DSP::PolyphaseDecimator<sample_t>(s_decimationFactor, s_audioBufferSize);
+			}
+
 			// Pad arrays with zeros
-			m_filterCoeff.fill(0.0f);
-			m_windowCoeffBuffer.fill(0.0f);
+			if constexpr (s_usesSpectrum)
+			{
+				m_fftInput.fill(0.0f);
+				m_shared->windowCoeffBuffer.fill(0.0f);
+			}
+
+			if constexpr (s_usesFilteredPowerSpectrum)
+			{
+				m_powerSpectrum.fill(0.0f);
+			}
 		}
 
 		PitchAnalyzer()						= delete;
@@ -117,6 +404,8 @@ namespace winrt::Tuner::implementation
 			if (samplingFrequency > 0.0f)
 			{
 				m_samplingFrequency = samplingFrequency;
+				m_detectorSettingsChanged.store(true, std::memory_order_release);
+				ResetPhaseVocoder();
 			}
 			else
 			{
@@ -131,7 +420,7 @@ namespace winrt::Tuner::implementation
 			if (baseToneFrequency > 0.0f)
 			{
 				m_baseToneFrequency = baseToneFrequency;
-				m_noteFrequenciesMap = std::move(InitializeNoteFrequenciesMap());
+				m_detectorSettingsChanged.store(true, std::memory_order_release);
 			}
 			else
 			{
@@ -140,21 +429,15 @@ namespace winrt::Tuner::implementation
 			}
 		}
 
-		void SetMinFrequency(float minFrequency) noexcept
+		// Frequency range changes take effect between two Analyze() calls. Filter of a range used recently
+		// is taken from the cache, a new one is designed in background and the analysis keeps
+		// the previous range until it is ready.
+		void SetMinFrequency(float minFrequency)
 		{
 			if (minFrequency >= 0.0f)
 			{
-				m_minFrequency = minFrequency;
-				
-				if (m_baseToneFrequency > 0.0f)
-				{
-					m_noteFrequenciesMap = std::move(InitializeNoteFrequenciesMap());
-				}
-
-				if (m_samplingFrequency > 0.0f)
-				{
-					GenerateNewFilter();
-				}
+				std::lock_guard<std::mutex> lock{ m_rangeMutex };
+				RequestFrequencyRange(minFrequency, m_requestedRange.maxFrequency);
 			}
 			else
 			{
@@ -163,22 +446,12 @@ namespace winrt::Tuner::implementation
 			}
 		}
 
-		void SetMaxFrequency(float maxFrequency) noexcept
+		void SetMaxFrequency(float maxFrequency)
 		{
 			if (maxFrequency >= 0.0f)
 			{
-				m_maxFrequency = maxFrequency;
-				m_noteFrequenciesMap = std::move(InitializeNoteFrequenciesMap());
-				
-				if (m_baseToneFrequency > 0.0f)
-				{
-					m_noteFrequenciesMap = std::move(InitializeNoteFrequenciesMap());
-				}
-
-				if (m_samplingFrequency > 0.0f)
-				{
-					GenerateNewFilter();
-				}
+				std::lock_guard<std::mutex> lock{ m_rangeMutex };
+				RequestFrequencyRange(m_requestedRange.minFrequency, maxFrequency);
 			}
 			else
 			{
@@ -191,18 +464,8 @@ namespace winrt::Tuner::implementation
 		{
 			if (minFrequency >= 0.0f && maxFrequency > 0.0f && maxFrequency > minFrequency)
 			{
-				m_minFrequency = minFrequency;
-				m_maxFrequency = maxFrequency;
-
-				if (m_baseToneFrequency > 0.0f)
-				{
-					m_noteFrequenciesMap = std::move(InitializeNoteFrequenciesMap());
-				}
-
-				if (m_samplingFrequency > 0.0f)
-				{
-					GenerateNewFilter();
-				}
+				std::lock_guard<std::mutex> lock{ m_rangeMutex };
+				RequestFrequencyRange(minFrequency, maxFrequency);
 			}
 			else
 			{
@@ -211,6 +474,75 @@ namespace winrt::Tuner::implementation
 			}
 		}
 		
+		// Set number of harmonics combined by the Harmonic Product Spectrum, at least 1
+		void SetHarmonicCount(size_t harmonicCount)
+		{
+			if (harmonicCount > 0U)
+			{
+				m_detector.SetHarmonicCount(harmonicCount);
+			}
+			else
+			{
+				// Bad value
+				WINRT_ASSERT(0);
+			}
+		}
+
+		// Set number of samples between the starts of windows passed to consecutive Analyze() calls.
+		// When set, frequency is refined from the phase difference between the frames (phase vocoder).
+		// 0 disables the refinement, e.g. when windows are not consecutive.
+		void SetHopSize(size_t hopSize) noexcept
+		{
+			m_hopSize			= hopSize;
+			m_streamedSamples	= 0U;
+			m_detectorSettingsChanged.store(true, std::memory_order_release);
+			ResetPhaseVocoder();
+		}
+
+		// Refine the frequency found by a spectral detector from the spectrum of the window evaluated by
+		// the chirp-z transform at s_zoomBinCount points between the FFT bins next to it. Replaces the phase
+		// vocoder refinement and works on single frames, at the cost of two complex FFTs of the window size.
+		// Its plans are created by Initialize() if enabled before, otherwise in background, and frames are
+		// refined once they are ready. Plans are kept when disabled. Must not be called while a frame is analyzed.
+		void SetZoomRefinement(bool enabled)
+		{
+			// Time-domain detectors have no spectrum to zoom into
+			WINRT_ASSERT(s_usesSpectrum || !enabled);
+			m_zoomRefinement = enabled;
+
+			if constexpr (s_usesSpectrum)
+			{
+				// Analysis thread takes over the transform only if the task was started
+				if (enabled && m_initialized && !m_zoomPlanningTask.valid() && !m_zoomTransform)
+				{
+					StartZoomPlanning();
+				}
+			}
+		}
+
+		// Forget the previous frame, e.g. after a gap in the input signal
+		void ResetPhaseVocoder() noexcept
+		{
+			m_detector.Reset();
+		}
+
+		// Get number of harmonics combined by the Harmonic Product Spectrum
+		size_t GetHarmonicCount() const noexcept
+		{
+			return m_detector.GetHarmonicCount();
+		}
+
+		// Access detector specific settings
+		Detector_t& GetDetector() noexcept
+		{
+			return m_detector;
+		}
+
+		const Detector_t& GetDetector() const noexcept
+		{
+			return m_detector;
+		}
+
 		// Attach function that gets called when sound analysis is completed
 		void SoundAnalyzed(SoundAnalyzedCallback soundAnalyzedCallback) noexcept
 		{
@@ -218,224 +550,952 @@ namespace winrt::Tuner::implementation
 			m_soundAnalyzedCallback = soundAnalyzedCallback;
 		}
 
-		// Deduce the best performant FFT algorithm or, if possible, load it from file
-		winrt::Windows::Foundation::IAsyncAction InitializeAsync()
+		// Publish results to the mailbox, so that consumers working at a different rate than the
+		// analysis always get the latest one. May be used instead of or together with the callback,
+		// nullptr detaches the mailbox. The analyzer is the only producer of the mailbox.
+		void PublishResults(ResultMailbox* resultMailbox) noexcept
+		{
+			m_resultMailbox = resultMailbox;
+		}
+
+		// Create the FFT plans and generate filter and window coefficients. FFTW wisdom
+		// loaded earlier or found in the wisdom store is used if available, otherwise FFTW deduces
+		// the best performant algorithm, which is then saved to the store. With background planning
+		// the forward plan is deduced while the analysis already runs on an estimated one.
+		void Initialize(const DSP::WisdomStore<sample_t>* wisdomStore = nullptr, FFTPlanning planning = FFTPlanning::blocking)
 		{
 			// Sampling frequency and base tone frequency must be set before initialization
 			WINRT_ASSERT(m_samplingFrequency > 0.0f);
 			WINRT_ASSERT(m_baseToneFrequency > 0.0f);
-			WINRT_ASSERT(!m_noteFrequenciesMap.empty());
 
-			if (!m_initialized)
 			{
-				// Check if FFT plan was created earlier
-				bool loadFFTResult = co_await DSP::FFTPlan<sample_t>::LoadFFTPlan(L"fft_plan.bin");
+				std::lock_guard<std::mutex> lock{ m_rangeMutex };
 
-				auto InitializeFFTPlan = [this](DSP::flags _flags) {
-					return DSP::FFTPlan<sample_t>(m_filterCoeff.begin(), m_filterCoeff.end(), m_filterFreqResponse.begin(), _flags);
-				};
+				// Range requested before initialization
+				m_minFrequency = m_requestedRange.minFrequency;
+				m_maxFrequency = m_requestedRange.maxFrequency;
+				m_requestedRangeReady.store(false, std::memory_order_relaxed);
 
-				m_fftPlan = InitializeFFTPlan(DSP::flags::wisdom);
+				// Decimator passes the band up to a quarter of the decimated sampling frequency without aliasing
+				WINRT_ASSERT(!s_decimates || m_maxFrequency <= 0.25f * GetAnalysisSamplingFrequency());
 
-				if (!m_fftPlan)
+				if constexpr (s_usesFilteredPowerSpectrum)
 				{
-					m_fftPlan = InitializeFFTPlan(DSP::flags::measure);
-					m_fftPlan.SaveFFTPlan(L"fft_plan.bin");
+					// Filters are designed off the analysis thread with their own plan, the forward plan
+					// may be replaced by the measured one in the meantime. Estimate plan is created instantly.
+					if (!m_filterFFTPlan)
+					{
+						m_filterDesignBuffers	= std::make_unique<FilterDesignBuffers>();
+						m_filterFFTPlan			= DSP::FFTPlan<sample_t>(m_filterDesignBuffers->input.begin(), m_filterDesignBuffers->input.end(), m_filterDesignBuffers->output.begin(), DSP::flags::estimate);
+						m_filterDesignBuffers->input.fill(0.0f);
+					}
+
+					// Generate filter coefficients and their frequency response
+					const DSP::FilterDesign design = GetFilterDesign(m_minFrequency, m_maxFrequency);
+					m_filter = m_filterCache.Find(design);
+
+					if (!m_filter)
+					{
+						m_filter = DesignFilter(design);
+						m_filterCache.Insert(design, m_filter);
+					}
+
+					m_requestedRange.filter = m_filter;
 				}
 			}
 
-			// FFT plan should be valid at this point
-			WINRT_ASSERT(m_fftPlan);
+			bool measureInBackground = false;
+
+			// Plans of detectors depending on the range are created for the range requested before initialization
+			if (!IsFFTPlanCreated())
+			{
+				measureInBackground = InitializeFFTPlan(wisdomStore, planning);
+			}
+
+			// FFT plans should be valid at this point
+			WINRT_ASSERT(IsFFTPlanCreated());
+
+			if constexpr (s_usesSpectrum)
+			{
+				if (m_zoomRefinement && !m_zoomTransform)
+				{
+					InitializeZoomTransform(wisdomStore, planning);
+				}
+			}
+
+			m_detector.ApplySettings(GetDetectorSettings());
+			m_detectorSettingsChanged.store(false, std::memory_order_relaxed);
+
+			if constexpr (s_usesSpectrum)
+			{
+				// Generate window coefficients
+				DSP::WindowGenerator::Generate(
+					DSP::WindowGenerator::WindowType::BlackmanHarris,
+					m_shared->windowCoeffBuffer.begin(),
+					m_shared->windowCoeffBuffer.end());
+			}
+
+			// Measuring holds the planner until it is done, so it starts after every plan created here
+			if (measureInBackground)
+			{
+				StartBackgroundPlanning(wisdomStore);
+			}
 
-			// Generate filter coefficients
-			DSP::GenerateBandPassFIR(
-				m_minFrequency,
-				m_maxFrequency,
-				m_samplingFrequency,
-				m_filterCoeff.begin(),
-				std::next(m_filterCoeff.begin(), s_filterSize),
-				DSP::WindowGenerator::WindowType::BlackmanHarris);
-
-			// Generate window coefficients
-			DSP::WindowGenerator::Generate(
-				DSP::WindowGenerator::WindowType::BlackmanHarris,
-				m_windowCoeffBuffer.begin(),
-				m_windowCoeffBuffer.end());
-
-			// Execute FFT for generated filter
-			m_fftPlan.Execute();
 			m_initialized = true;
 
 #ifdef CREATE_MATLAB_PLOTS
-			ExportFilterMatlab();
+			if constexpr (s_usesFilteredPowerSpectrum)
+			{
+				ExportFilterMatlab();
+			}
 #endif
 		}
 
-		// Function performs harmonic analysis on input signal and calls the callback function
-		// for each analysis performed.
+#ifdef DSP_WINRT_STORAGE
+		// Load the best performant FFT algorithm from the wisdom store in the app's storage folder or,
+		// if not available, start with an estimated one and deduce it in background. Continues on
+		// a background thread.
+		winrt::Windows::Foundation::IAsyncAction InitializeAsync()
+		{
+			co_await winrt::resume_background();
+
+			const std::filesystem::path localFolder{ winrt::Windows::Storage::ApplicationData::Current().LocalFolder().Path().c_str() };
+			const DSP::WisdomStore<sample_t> wisdomStore{ localFolder / L"fftw_wisdom" };
+
+			Initialize(&wisdomStore, FFTPlanning::background);
+		}
+#endif
+
+		// Function performs pitch detection on input signal and calls the callback function
+		// for each analysis performed. Input samples are not modified, so overlapping
+		// windows may share the same memory.
 		template<typename _FwdIt>
 		void Analyze(_FwdIt first, _FwdIt last) noexcept
 		{
 			// Object must be properly initialized
 			WINRT_ASSERT(m_initialized);
-			// SoundAnalyzed callback must be attached before performing analysis.
-			WINRT_ASSERT(m_soundAnalyzedCallback);
+			// SoundAnalyzed callback or result mailbox must be attached before performing analysis.
+			WINRT_ASSERT(m_soundAnalyzedCallback || m_resultMailbox);
+
+			if constexpr (s_usesSpectrum)
+			{
+				// Plan measured in background replaces the estimated one between frames
+				if (m_measuredFFTPlanReady.load(std::memory_order_acquire))
+				{
+					SwapMeasuredFFTPlan();
+				}
+
+				if (m_createdZoomTransformReady.load(std::memory_order_acquire))
+				{
+					TakeCreatedZoomTransform();
+				}
+			}
+
+			if (m_requestedRangeReady.load(std::memory_order_acquire))
+			{
+				ApplyRequestedRange();
+			}
+
+			ApplyDetectorSettings();
+			PublishResult(AnalyzeFrame(first, last));
+		}
+
+		// Analyze a continuous stream passed in consecutive chunks of any length, e.g. as the audio device
+		// delivers them. Spectrum of the newest s_audioBufferSize samples is updated sample by sample by
+		// a sliding DFT over the bins of the requested range and analyzed every hop size samples (SetHopSize),
+		// once the first window is complete. A sample costs a few multiply-adds per bin whatever the hop,
+		// instead of a window and an FFT per frame, which pays off for short hops. Results are delivered
+		// as by Analyze(). Decimator works on separate windows, so the stream is analyzed at full rate.
+		// The first call and range changes rebuild the sliding DFT.
+		template<typename _FwdIt>
+		void AnalyzeStream(_FwdIt first, _FwdIt last)
+		{
+			static_assert(s_usesSpectrum, "Sliding DFT computes the spectrum, the detector must use it.");
+			static_assert(!s_decimates, "Decimator works on separate windows, not on a stream.");
+
+			// Object must be properly initialized
+			WINRT_ASSERT(m_initialized);
+			// SoundAnalyzed callback or result mailbox must be attached before performing analysis.
+			WINRT_ASSERT(m_soundAnalyzedCallback || m_resultMailbox);
+			// Frames are analyzed every hop size samples
+			WINRT_ASSERT(m_hopSize > 0U);
+
+			if (m_createdZoomTransformReady.load(std::memory_order_acquire))
+			{
+				TakeCreatedZoomTransform();
+			}
+
+			if (m_requestedRangeReady.load(std::memory_order_acquire))
+			{
+				ApplyRequestedRange();
+			}
+
+			ApplyDetectorSettings();
+
+			const size_t binCount = GetSlidingBinCount();
+
+			if (!m_slidingDFT)
+			{
+				const auto& coefficients = DSP::WindowGenerator::s_blackmanHarrisCoefficients;
+				m_slidingDFT = SlidingDFT_t(s_audioBufferSize, s_fftSize, 0U, binCount, coefficients.begin(), coefficients.end());
+			}
+			else if (m_slidingDFT.GetBinCount() != binCount)
+			{
+				m_slidingDFT.SetBinRange(0U, binCount);
+			}
+
+			const size_t hopSize = std::max(m_hopSize, size_t{ 1U });
+
+			while (first != last)
+			{
+				const size_t count		= std::min(hopSize - m_streamedSamples, static_cast<size_t>(std::distance(first, last)));
+				const _FwdIt chunkLast	= std::next(first, count);
+
+#ifdef PROFILE_ANALYSIS_STAGES
+				const auto updateStart = std::chrono::steady_clock::now();
+#endif
+				m_slidingDFT.Process(first, chunkLast);
+#ifdef PROFILE_ANALYSIS_STAGES
+				m_slidingUpdateTime += std::chrono::steady_clock::now() - updateStart;
+#endif
+
+				first				= chunkLast;
+				m_streamedSamples	+= count;
+
+				if (m_streamedSamples == hopSize)
+				{
+					m_streamedSamples = 0U;
+
+					if (m_slidingDFT.IsFilled())
+					{
+						PublishResult(AnalyzeSlidingFrame());
+					}
+				}
+			}
+		}
+
+		// Analyze a whole recording, e.g. offline, in windows of s_audioBufferSize samples starting every
+		// hopSize samples. Windows are split into contiguous blocks analyzed in parallel by workers, each
+		// with its own buffers and detector, sharing the filter, window and FFT plan of this analyzer.
+		// Returns one point per window, threadCount 0 uses all hardware threads. Callback and mailbox
+		// are not used and the settings must not change until the call returns. Background planning
+		// started by Initialize() is waited for before the workers create their plans.
+		template<typename _RanIt>
+		std::vector<PitchTrackPoint> AnalyzeRecording(_RanIt first, _RanIt last, size_t hopSize, size_t threadCount = 0U) const
+		{
+			// Object must be properly initialized
+			WINRT_ASSERT(m_initialized);
+			WINRT_ASSERT(hopSize > 0U);
+
+			const size_t sampleCount = static_cast<size_t>(std::distance(first, last));
+
+			if (hopSize == 0U || sampleCount < s_audioBufferSize)
+			{
+				return {};
+			}
+
+			const size_t windowCount = (sampleCount - s_audioBufferSize) / hopSize + 1U;
+
+			if (threadCount == 0U)
+			{
+				threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+			}
+
+			threadCount = std::min(threadCount, windowCount);
 
-			// Get helper iterators
-			auto filterFreqResponseFirst	= m_filterFreqResponse.begin();
-			auto fftResultFirst				= m_fftResult.begin();
-			auto fftResultLast				= std::next(fftResultFirst, s_fftResultSize);
-			auto windowCoeffBufferFirst		= m_windowCoeffBuffer.begin();
+			// Detectors working on part of the window report its center, window size is given after decimation
+			const double windowCenter = static_cast<double>(s_audioBufferSize) - 0.5 * static_cast<double>(m_detector.GetWindowSize() * s_decimationFactor);
 
-			// Apply window function before FFT
-			DSP::MultiplyPointwise(first, last, windowCoeffBufferFirst, first);
+			// Plans of the workers would wait for the planner held by background planning, which is
+			// finished first, so that they are created from its wisdom without contention
+			if (m_planningTask.valid())
+			{
+				m_planningTask.wait();
+			}
 
-			// Execute FFT on the input signal
-			m_fftPlan.Execute(first, last, fftResultFirst);
+			if (m_zoomPlanningTask.valid())
+			{
+				m_zoomPlanningTask.wait();
+			}
 
-			// Apply FIR filter to the input signal
-			DSP::MultiplyPointwise(fftResultFirst, fftResultLast, filterFreqResponseFirst, fftResultFirst);
+			// Workers are created on this thread before any block starts, planning is serialized anyway
+			std::vector<std::unique_ptr<PitchAnalyzer>> workers;
+			workers.reserve(threadCount);
+
+			for (size_t workerIndex = 0U; workerIndex < threadCount; workerIndex++)
+			{
+				workers.push_back(std::unique_ptr<PitchAnalyzer>(new PitchAnalyzer(*this, hopSize)));
+			}
+
+			std::vector<PitchTrackPoint> pitchTrack(windowCount);
+
+			// Consecutive windows of a block let the detector use the previous one
+			auto AnalyzeBlock = [&](size_t workerIndex) noexcept {
+				PitchAnalyzer& worker		= *workers[workerIndex];
+				const size_t windowFirst	= windowCount * workerIndex / threadCount;
+				const size_t windowLast		= windowCount * (workerIndex + 1U) / threadCount;
+
+				for (size_t window = windowFirst; window < windowLast; window++)
+				{
+					const size_t offset		= window * hopSize;
+					const _RanIt windowIt	= std::next(first, offset);
+
+					pitchTrack[window] = {
+						(static_cast<double>(offset) + windowCenter) / static_cast<double>(m_samplingFrequency),
+						worker.AnalyzeFrame(windowIt, std::next(windowIt, s_audioBufferSize))
+					};
+				}
+			};
+
+			// Calling thread analyzes the first block
+			std::vector<std::future<void>> blocks;
+			blocks.reserve(threadCount - 1U);
+
+			for (size_t workerIndex = 1U; workerIndex < threadCount; workerIndex++)
+			{
+				blocks.push_back(std::async(std::launch::async, AnalyzeBlock, workerIndex));
+			}
+
+			AnalyzeBlock(0U);
+
+			for (auto& block : blocks)
+			{
+				block.get();
+			}
+
+			return pitchTrack;
+		}
+
+#ifdef PROFILE_ANALYSIS_STAGES
+		// Get time spent in each stage of the last Analyze() call
+		const StageTimings& GetStageTimings() const noexcept
+		{
+			return m_stageTimings;
+		}
+#endif
+
+		// Get origin, cost and planning times of the forward FFT plan, may be called from any thread.
+		// Detectors without the spectrum have no forward plan.
+		FFTPlanStatistics GetFFTPlanStatistics() const noexcept
+		{
+			return {
+				m_fftPlanSource.load(std::memory_order_relaxed),
+				m_fftPlanFlops.load(std::memory_order_relaxed),
+				m_planningTime.load(std::memory_order_relaxed),
+				m_backgroundPlanningTime.load(std::memory_order_relaxed),
+				m_backgroundPlanningPending.load(std::memory_order_relaxed)
+			};
+		}
+
+	private:
+
+		// Worker of AnalyzeRecording(), has its own buffers and a copy of the detector and shares
+		// the rest with the prototype, which must be initialized
+		PitchAnalyzer(const PitchAnalyzer& prototype, size_t hopSize) :
+			m_resultMailbox				{ nullptr },
+			m_decimator					{ prototype.m_decimator },
+			m_streamedSamples			{ 0U },
+			m_shared					{ prototype.m_shared },
+			m_detector					{ prototype.m_detector },
+			m_hopSize					{ hopSize },
+			m_zoomRefinement			{ prototype.m_zoomRefinement },
+			m_minFrequency				{ prototype.m_minFrequency },
+			m_maxFrequency				{ prototype.m_maxFrequency },
+			m_baseToneFrequency			{ prototype.m_baseToneFrequency },
+			m_samplingFrequency			{ prototype.m_samplingFrequency },
+			m_initialized				{ prototype.m_initialized },
+			m_detectorSettingsChanged	{ false },
+			m_filter					{ prototype.m_filter },
+			m_requestedRange			{ prototype.m_minFrequency, prototype.m_maxFrequency, prototype.m_filter }
+		{
+			if constexpr (s_usesSpectrum)
+			{
+				m_fftInput.fill(0.0f);
+
+				// Plans of the prototype left their wisdom, an estimated plan is the fallback
+				if (m_zoomRefinement)
+				{
+					m_zoomTransform = CreateZoomTransform(DSP::flags::wisdom);
+
+					if (!m_zoomTransform)
+					{
+						m_zoomTransform = CreateZoomTransform(DSP::flags::estimate);
+					}
+				}
+			}
+
+			if constexpr (s_usesFilteredPowerSpectrum)
+			{
+				m_powerSpectrum.fill(0.0f);
+			}
+
+			if constexpr (Detector_t::s_usesInverseFFT)
+			{
+				m_detector.InitializeFFTPlans(GetDetectorSettings());
+			}
+
+			m_detector.ApplySettings(GetDetectorSettings());
+		}
+
+		// Detect pitch of a single window, frequency of the result is 0 if no pitch was found in the requested range
+		template<typename _FwdIt>
+		PitchAnalysisResult AnalyzeFrame(_FwdIt first, _FwdIt last) noexcept
+		{
+			// Input must fill the whole analysis window
+			WINRT_ASSERT(std::distance(first, last) == s_audioBufferSize);
+
+			const DetectorSettings settings = GetDetectorSettings();
+			PitchEstimate estimate{ 0.0f, 0.0f };
+
+			PROFILE_STAGE_BEGIN();
+
+			// Decimated window or the input itself
+			const auto [windowFirst, windowLast] = DecimateWindow(first, last);
+			PROFILE_STAGE_END(decimation);
+
+			if constexpr (s_usesSpectrum)
+			{
+				// Get helper pointers, contiguous buffers are processed by the SIMD kernels
+				auto fftInputFirst			= m_fftInput.data();
+				auto fftResultFirst			= m_fftResult.data();
+				auto windowCoeffBufferFirst	= m_shared->windowCoeffBuffer.data();
+
+				// Apply window function before FFT, samples past the window stay zero
+				DSP::MultiplyPointwise(windowFirst, windowLast, windowCoeffBufferFirst, fftInputFirst);
+				PROFILE_STAGE_END(window);
+
+				// Execute FFT on the windowed input signal
+				m_shared->fftPlan.Execute(fftInputFirst, std::next(fftInputFirst, s_fftSize), fftResultFirst);
+				PROFILE_STAGE_END(fft);
+
+#ifdef PROFILE_ANALYSIS_STAGES
+				m_stageTimings.slidingDFT = std::chrono::nanoseconds(0);
+#endif
+				estimate = DetectInSpectrum(settings);
+			}
+			else
+			{
+				estimate = m_detector.Detect(windowFirst, windowLast, settings);
+				PROFILE_STAGE_END(detection);
+			}
+
+			return GetAnalysisResult(estimate);
+		}
+
+		// Detect pitch in the spectrum of the newest window of the stream
+		PitchAnalysisResult AnalyzeSlidingFrame() noexcept
+		{
+			const DetectorSettings settings = GetDetectorSettings();
+
+			PROFILE_STAGE_BEGIN();
+
+			m_slidingDFT.Spectrum(m_fftResult.begin());
+
+			// Zoom transform works on the windowed samples
+			if (m_zoomRefinement && m_zoomTransform)
+			{
+				m_slidingDFT.CopyWindow(m_fftInput.begin());
+				DSP::MultiplyPointwise(m_fftInput.data(), m_fftInput.data() + s_analysisBufferSize, m_shared->windowCoeffBuffer.data(), m_fftInput.data());
+			}
+
+#ifdef PROFILE_ANALYSIS_STAGES
+			const auto spectrumEnd = std::chrono::steady_clock::now();
+
+			m_stageTimings.slidingDFT	= m_slidingUpdateTime + (spectrumEnd - profiledStageStart);
+			m_stageTimings.decimation	= std::chrono::nanoseconds(0);
+			m_stageTimings.window		= std::chrono::nanoseconds(0);
+			m_stageTimings.fft			= std::chrono::nanoseconds(0);
+			m_slidingUpdateTime			= std::chrono::nanoseconds(0);
+#endif
+
+			return GetAnalysisResult(DetectInSpectrum(settings));
+		}
+
+		// Filter the spectrum in m_fftResult, detect pitch and refine it from the zoomed spectrum of the
+		// windowed signal in m_fftInput if enabled
+		PitchEstimate DetectInSpectrum(const DetectorSettings& settings) noexcept
+		{
+			PROFILE_STAGE_BEGIN();
+
+			auto fftResultFirst = m_fftResult.data();
+
+			// Bins outside of the requested frequency range are never read by the detector
+			SpectrumFrame<sample_t> frame{ fftResultFirst, nullptr, GetBinIndex(m_minFrequency), GetSpectrumBinCount() };
+
+			if constexpr (s_usesFilteredPowerSpectrum)
+			{
+				// Apply FIR filter and compute the power spectrum in a single pass over the used bins,
+				// |X * H|^2 = |X|^2 * |H|^2 so the filter is applied as its squared magnitude
+				frame.powerSpectrum = m_powerSpectrum.data();
+				DSP::WeightedPowerSpectrum(fftResultFirst, std::next(fftResultFirst, frame.binCount), m_filter->powerResponse.data(), frame.powerSpectrum);
+				PROFILE_STAGE_END(filter);
+			}
 
 #ifdef CREATE_MATLAB_PLOTS
-			ExportSoundAnalysisMatlab(first, fftResultFirst).get();
+			ExportSoundAnalysisMatlab(m_fftInput.data(), m_fftResult.data()).get();
 			// Pause debugging, Matlab .m files are now ready
 			__debugbreak();
 #endif
 
-			float firstHarmonic = HarmonicProductSpectrum(fftResultFirst, fftResultLast);
+			PitchEstimate estimate = m_detector.Detect(frame, settings);
+			PROFILE_STAGE_END(detection);
+
+			if (m_zoomRefinement && m_zoomTransform && estimate.frequency > 0.0f)
+			{
+				// Windowed signal is still in the FFT input
+				estimate.frequency = ZoomIntoPeak(estimate.frequency);
+				PROFILE_STAGE_END(zoom);
+			}
+#ifdef PROFILE_ANALYSIS_STAGES
+			else
+			{
+				m_stageTimings.zoom = std::chrono::nanoseconds(0);
+			}
+#endif
+
+			return estimate;
+		}
+
+		// Nearest note of the estimate if it is in the requested range, frequency of the result is 0 otherwise
+		PitchAnalysisResult GetAnalysisResult(const PitchEstimate& estimate) noexcept
+		{
+			PROFILE_STAGE_BEGIN();
 
 			// Check if frequency of the peak is in the requested range
-			if (firstHarmonic >= m_minFrequency && firstHarmonic <= m_maxFrequency)
+			if (estimate.frequency > 0.0f && estimate.frequency >= m_minFrequency && estimate.frequency <= m_maxFrequency)
 			{
-				PitchAnalysisResult measurement = GetNote(firstHarmonic);
-				m_soundAnalyzedCallback(measurement.note, firstHarmonic, measurement.cents);
+				PitchAnalysisResult result	= GetNearestNote(estimate.frequency, m_baseToneFrequency);
+				result.confidence			= estimate.confidence;
+				PROFILE_STAGE_END(noteLookup);
+
+				return result;
 			}
+
+#ifdef PROFILE_ANALYSIS_STAGES
+			m_stageTimings.noteLookup = std::chrono::nanoseconds(0);
+#endif
+			return {};
 		}
 
-	private:
+		// Deliver a result with a pitch to the mailbox and the callback
+		void PublishResult(const PitchAnalysisResult& result) noexcept
+		{
+			if (result.frequency > 0.0f)
+			{
+				if (m_resultMailbox)
+				{
+					m_resultMailbox->Publish(result);
+				}
+
+				if (m_soundAnalyzedCallback)
+				{
+					m_soundAnalyzedCallback(result);
+				}
+			}
+		}
 
-		// Function used to fill the noteFrequencies NoteFrequenciesMap.
-		NoteFrequenciesMap InitializeNoteFrequenciesMap() noexcept
+		// Check if FFT plans required by the detector exist
+		bool IsFFTPlanCreated() const noexcept
 		{
-			constexpr std::array<const char*, 12> octave{ "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+			bool created = true;
+
+			if constexpr (s_usesSpectrum)
+			{
+				created = created && m_shared->fftPlan;
+			}
 
-			// Constant needed for note frequencies calculation
-			const float a			= pow(2.0f, 1.0f / 12.0f);
-			const auto baseNoteIter	= std::next(octave.begin(), 9);
+			if constexpr (Detector_t::s_usesInverseFFT)
+			{
+				created = created && m_detector.IsFFTPlanCreated();
+			}
 
-			auto octaveIter			= baseNoteIter;
-			float currentFrequency	= m_baseToneFrequency;
-			int currentOctave		= 4;
-			int halfSteps			= 0;
+			return created;
+		}
 
-			NoteFrequenciesMap result;
+		// Create FFT plans required by the detector from wisdom or, if not available, measure them
+		// and save the new wisdom to the store. Returns true if the forward plan is estimated
+		// and should be measured in background instead.
+		bool InitializeFFTPlan(const DSP::WisdomStore<sample_t>* wisdomStore, FFTPlanning planning)
+		{
+			bool measureInBackground = false;
 
-			// Fill a map for notes below  A4
-			while (currentFrequency >= m_minFrequency)
+			if constexpr (s_usesSpectrum)
 			{
-				currentFrequency = m_baseToneFrequency * std::pow(a, halfSteps);
-				result[currentFrequency] = std::string(*octaveIter) + std::to_string(currentOctave);
-				halfSteps--;
+				if (!m_shared->fftPlan)
+				{
+					auto CreateFFTPlan = [this](DSP::flags _flags) {
+						return DSP::FFTPlan<sample_t>(m_fftInput.begin(), m_fftInput.end(), m_fftResult.begin(), _flags);
+					};
+
+					const DSP::WisdomKey key = GetFFTWisdomKey();
+
+					if (wisdomStore)
+					{
+						wisdomStore->Load(key);
+					}
+
+					const auto planningStart	= std::chrono::steady_clock::now();
+					FFTPlanSource source		= FFTPlanSource::wisdom;
+					m_shared->fftPlan			= CreateFFTPlan(DSP::flags::wisdom);
+
+					if (!m_shared->fftPlan && planning == FFTPlanning::background)
+					{
+						m_shared->fftPlan	= CreateFFTPlan(DSP::flags::estimate);
+						source				= FFTPlanSource::estimate;
+					}
+					else if (!m_shared->fftPlan)
+					{
+						m_shared->fftPlan	= CreateFFTPlan(DSP::flags::measure);
+						source				= FFTPlanSource::measure;
+
+						if (wisdomStore)
+						{
+							wisdomStore->Save(key);
+						}
+					}
+
+					m_planningTime.store(std::chrono::steady_clock::now() - planningStart, std::memory_order_relaxed);
+					m_fftPlanFlops.store(m_shared->fftPlan.GetFlops(), std::memory_order_relaxed);
+					m_fftPlanSource.store(source, std::memory_order_relaxed);
+
+					// Measuring overwrites the zero padding
+					m_fftInput.fill(0.0f);
+
+					measureInBackground = source == FFTPlanSource::estimate;
+				}
+			}
 
-				if (octaveIter == octave.begin())
+			if constexpr (Detector_t::s_usesInverseFFT)
+			{
+				if (!m_detector.IsFFTPlanCreated())
 				{
-					octaveIter = octave.end();
-					currentOctave--;
+					m_detector.InitializeFFTPlans(GetDetectorSettings(), wisdomStore);
 				}
+			}
+
+			return measureInBackground;
+		}
+
+		// Wisdom of the forward plan
+		static DSP::WisdomKey GetFFTWisdomKey() noexcept
+		{
+			return { DSP::transform::r2c, s_fftSize };
+		}
 
-				octaveIter = std::prev(octaveIter, 1);
+		// Measure the optimal forward plan on separate buffers of the same size and alignment,
+		// the analysis keeps running on the estimated plan in the meantime
+		void StartBackgroundPlanning(const DSP::WisdomStore<sample_t>* wisdomStore)
+		{
+			struct PlanningBuffers
+			{
+				alignas(s_bufferAlignment) SampleBuffer		input;
+				alignas(s_bufferAlignment) FFTResultBuffer	output;
+			};
+
+			// Store passed to Initialize() may not outlive the task
+			std::optional<DSP::WisdomStore<sample_t>> store;
+
+			if (wisdomStore)
+			{
+				store.emplace(*wisdomStore);
 			}
 
-			// Set iterator to one half-step above A4
-			octaveIter		= std::next(baseNoteIter, 1);
-			halfSteps		= 1;
-			currentOctave	= 4;
+			m_backgroundPlanningPending.store(true, std::memory_order_relaxed);
+
+			m_planningTask = std::async(std::launch::async, [this, store = std::move(store)]() {
+				const auto planningStart	= std::chrono::steady_clock::now();
+				auto buffers				= std::make_unique<PlanningBuffers>();
 
-			// Fill a map for notes above and equal A4
-			while (currentFrequency <= m_maxFrequency) {
+				DSP::FFTPlan<sample_t> fftPlan(buffers->input.begin(), buffers->input.end(), buffers->output.begin(), DSP::flags::measure);
+				const auto planningTime = std::chrono::steady_clock::now() - planningStart;
 
-				if (octaveIter == octave.end())
+				if (store)
 				{
-					octaveIter = octave.begin();
-					currentOctave++;
+					store->Save(GetFFTWisdomKey());
 				}
 
-				currentFrequency = m_baseToneFrequency * std::pow(a, halfSteps);
-				result[currentFrequency] = std::string(*octaveIter) + std::to_string(currentOctave);
-				halfSteps++;
-				std::advance(octaveIter, 1);
-			}
+				m_measuredFFTPlanFlops	= fftPlan.GetFlops();
+				m_measuredFFTPlan		= std::move(fftPlan);
+				m_measuredFFTPlanReady.store(true, std::memory_order_release);
 
-			return result;
+				// Published last, a nonzero time means the plan is ready to be swapped in
+				m_backgroundPlanningTime.store(planningTime, std::memory_order_relaxed);
+			});
+		}
+
+		// Put the measured plan in use. The estimated one is kept until the analyzer is destroyed,
+		// destroying it here could block the analysis thread on the planner.
+		void SwapMeasuredFFTPlan() noexcept
+		{
+			m_shared->fftPlan.Swap(m_measuredFFTPlan);
+			m_measuredFFTPlanReady.store(false, std::memory_order_relaxed);
+
+			m_fftPlanFlops.store(m_measuredFFTPlanFlops, std::memory_order_relaxed);
+			m_fftPlanSource.store(FFTPlanSource::measure, std::memory_order_relaxed);
+			m_backgroundPlanningPending.store(false, std::memory_order_relaxed);
+		}
+
+		// Sampling frequency of the analyzed window, after decimation
+		float GetAnalysisSamplingFrequency() const noexcept
+		{
+			return m_samplingFrequency / static_cast<float>(s_decimationFactor);
+		}
+
+		// Settings at the decimated sampling frequency. Phase vocoder needs a whole number of decimated
+		// samples between the frames, otherwise it is disabled.
+		DetectorSettings GetDetectorSettings() const noexcept
+		{
+			const size_t hopSize = m_hopSize % s_decimationFactor == 0U ? m_hopSize / s_decimationFactor : 0U;
+
+			return { GetAnalysisSamplingFrequency(), m_minFrequency, m_maxFrequency, hopSize, m_baseToneFrequency };
+		}
+
+		// Low-pass filter and decimate the window if the analyzer decimates, otherwise pass it through
+		template<typename _FwdIt>
+		auto DecimateWindow(_FwdIt first, _FwdIt last) noexcept
+		{
+			if constexpr (s_decimates)
+			{
+				m_decimator.Decimate(first, last, m_decimatedInput.begin());
+				return std::make_pair(m_decimatedInput.data(), m_decimatedInput.data() + s_analysisBufferSize);
+			}
+			else
+			{
+				return std::make_pair(first, last);
+			}
 		}
 
-		// Analyze FFT result and find the base tone frequency
-		template<typename _InIt>
-		float HarmonicProductSpectrum(_InIt first, _InIt last) const noexcept
+		ZoomTransform_t CreateZoomTransform(DSP::flags _flags) const
 		{
-			using value_t	= typename std::iterator_traits<_InIt>::value_type;
-			using diff_t	= typename std::iterator_traits<_InIt>::difference_type;
+			return ZoomTransform_t(s_analysisBufferSize, s_zoomBinCount, s_zoomBinSpacing, _flags);
+		}
 
-			// Number of samples
-			static const diff_t N = std::distance(first, last);
+		// Create the zoom transform from wisdom or, if not available, measure its plans and save the new
+		// wisdom. Its plans are estimated instead with background planning.
+		void InitializeZoomTransform(const DSP::WisdomStore<sample_t>* wisdomStore, FFTPlanning planning)
+		{
+			const DSP::WisdomKey key{ DSP::transform::c2c, ZoomTransform_t::GetFFTSize(s_analysisBufferSize, s_zoomBinCount) };
 
-			// Iterator to the upper frequency boundary
-			static const _InIt maxFreqIter = std::next(first, static_cast<diff_t>(1U + static_cast<diff_t>(m_maxFrequency) * N / static_cast<diff_t>(m_samplingFrequency)));
+			if (wisdomStore)
+			{
+				wisdomStore->Load(key);
+			}
 
-			// Index of the sample representing lower frequency bound
-			diff_t n = static_cast<diff_t>(m_minFrequency) * N / static_cast<diff_t>(m_samplingFrequency);
-			auto highestSumIndex = std::make_pair(0.0f, 0.0f);
+			m_zoomTransform = CreateZoomTransform(DSP::flags::wisdom);
 
-			for (; std::distance(std::next(first, 3 * n), maxFreqIter) > 0; n++)
+			if (!m_zoomTransform && planning == FFTPlanning::background)
 			{
-				auto currentSumIndex = std::make_pair(
-					std::abs(*std::next(first, n)) *
-					std::abs(*std::next(first, 2 * n)) *
-					std::abs(*std::next(first, 3 * n)), n);
+				m_zoomTransform = CreateZoomTransform(DSP::flags::estimate);
+			}
+			else if (!m_zoomTransform)
+			{
+				m_zoomTransform = CreateZoomTransform(DSP::flags::measure);
 
-				if (currentSumIndex.first > highestSumIndex.first)
+				if (wisdomStore)
 				{
-					highestSumIndex = currentSumIndex;
+					wisdomStore->Save(key);
 				}
 			}
+		}
+
+		// Create the zoom transform from wisdom or estimated on a task, planning on the caller's thread
+		// would wait for the planner while a background measure holds it
+		void StartZoomPlanning()
+		{
+			m_zoomPlanningTask = std::async(std::launch::async, [this]() {
+				ZoomTransform_t zoomTransform = CreateZoomTransform(DSP::flags::wisdom);
+
+				if (!zoomTransform)
+				{
+					zoomTransform = CreateZoomTransform(DSP::flags::estimate);
+				}
 
-			return highestSumIndex.second * m_samplingFrequency / static_cast<float>(N);
+				m_createdZoomTransform = std::move(zoomTransform);
+				m_createdZoomTransformReady.store(true, std::memory_order_release);
+			});
+		}
+
+		// Put the zoom transform created in background in use, the one in use is empty
+		void TakeCreatedZoomTransform() noexcept
+		{
+			m_zoomTransform = std::move(m_createdZoomTransform);
+			m_createdZoomTransformReady.store(false, std::memory_order_relaxed);
 		}
 
-		// Analyzes input frequency and returns a filled PitchAnalysisResult struct
-		PitchAnalysisResult GetNote(float frequency) const noexcept
+		// Frequency of the peak of the windowed signal's spectrum zoomed around the estimate, with Gaussian
+		// interpolation between the zoomed bins. The estimate is kept if the peak is not inside the band.
+		float ZoomIntoPeak(float frequency) noexcept
 		{
-			// Get the nearest note above or equal
-			auto high = m_noteFrequenciesMap.lower_bound(frequency);
-			// Get the nearest note below
-			auto low = std::prev(high);
+			const double samplingFrequency	= static_cast<double>(GetAnalysisSamplingFrequency());
+			const double firstFrequency		= static_cast<double>(frequency) / samplingFrequency - 0.5 * s_zoomBinSpacing * static_cast<double>(s_zoomBinCount - 1U);
 
-			// Get differences between current frequency and the nearest "valid" tones
-			float highDiff = (*high).first - frequency;
-			float lowDiff = frequency - (*low).first;
+			m_zoomTransform.Transform(m_fftInput.begin(), std::next(m_fftInput.begin(), s_analysisBufferSize), firstFrequency, m_zoomSpectrum.begin());
 
-			if (highDiff < lowDiff)
+			auto logNorm = [this](size_t index) {
+				return std::log(std::max(std::norm(m_zoomSpectrum[index]), std::numeric_limits<sample_t>::min()));
+			};
+
+			size_t peak = 0U;
+
+			for (size_t bin = 1U; bin < s_zoomBinCount; bin++)
 			{
-				return { (*high).second, 1200.0f * std::log2(frequency / (*high).first) };
+				if (std::norm(m_zoomSpectrum[bin]) > std::norm(m_zoomSpectrum[peak]))
+				{
+					peak = bin;
+				}
 			}
-			else
+
+			if (peak == 0U || peak + 1U == s_zoomBinCount)
 			{
-				return { (*low).second, 1200.0f * std::log2(frequency / (*low).first) };
+				return frequency;
 			}
+
+			const double offset = static_cast<double>(DSP::GaussianPeakOffset(logNorm(peak - 1U), logNorm(peak), logNorm(peak + 1U)));
+
+			return static_cast<float>((firstFrequency + (static_cast<double>(peak) + offset) * s_zoomBinSpacing) * samplingFrequency);
+		}
+
+		// Index of the FFT bin nearest to the given frequency, rounded once so that fractional frequencies
+		// and sampling frequencies do not shift it
+		size_t GetBinIndex(float frequency) const noexcept
+		{
+			return static_cast<size_t>(std::lround(frequency * s_fftSize / GetAnalysisSamplingFrequency()));
+		}
+
+		// One past the last bin of the requested frequency range
+		size_t GetSpectrumBinCount() const noexcept
+		{
+			return std::min(s_fftResultSize, GetBinIndex(m_maxFrequency) + 1U);
 		}
 
-		void GenerateNewFilter()
+		// Bins computed by the sliding DFT, one more than the detector uses for the interpolation at the top of the range
+		size_t GetSlidingBinCount() const noexcept
 		{
-			// Generate filter coefficients
+			return std::min(s_fftResultSize, GetSpectrumBinCount() + 1U);
+		}
+
+		DSP::FilterDesign GetFilterDesign(float minFrequency, float maxFrequency) const noexcept
+		{
+			return { minFrequency, maxFrequency, GetAnalysisSamplingFrequency(), s_filterWindowType, s_filterSize };
+		}
+
+		// Generate filter coefficients and the power of their frequency response. Called by one thread
+		// at a time, Initialize() or the design task.
+		std::shared_ptr<const FilterResponse> DesignFilter(const DSP::FilterDesign& design)
+		{
+			auto filter = std::make_shared<FilterResponse>();
+
 			DSP::GenerateBandPassFIR(
-				m_minFrequency,
-				m_maxFrequency,
-				m_samplingFrequency,
-				m_filterCoeff.begin(),
-				std::next(m_filterCoeff.begin(), s_filterSize),
-				DSP::WindowGenerator::WindowType::BlackmanHarris);
+				design.lowCutoff,
+				design.highCutoff,
+				design.samplingFrequency,
+				filter->coefficients.begin(),
+				filter->coefficients.end(),
+				design.windowType);
+
+			// Samples past the filter stay zero
+			std::copy(filter->coefficients.begin(), filter->coefficients.end(), m_filterDesignBuffers->input.begin());
+			m_filterFFTPlan.Execute();
+
+			std::transform(m_filterDesignBuffers->output.begin(), m_filterDesignBuffers->output.end(), filter->powerResponse.begin(), [](const complex_t& bin) {
+				return std::norm(bin);
+			});
+
+			return filter;
+		}
+
+		// Record the requested range and look its filter up or start designing it, m_rangeMutex must be held
+		void RequestFrequencyRange(float minFrequency, float maxFrequency)
+		{
+			m_requestedRange.minFrequency = minFrequency;
+			m_requestedRange.maxFrequency = maxFrequency;
+
+			if constexpr (s_usesFilteredPowerSpectrum)
+			{
+				// Before initialization the filter is designed by Initialize()
+				if (!m_filterFFTPlan)
+				{
+					return;
+				}
+
+				// Filter the analysis thread has not taken yet is released here, not on that thread
+				m_requestedRange.filter = m_filterCache.Find(GetFilterDesign(minFrequency, maxFrequency));
+
+				if (!m_requestedRange.filter)
+				{
+					m_requestedRangeReady.store(false, std::memory_order_relaxed);
+					StartFilterDesign();
+					return;
+				}
+			}
+
+			m_requestedRangeReady.store(true, std::memory_order_release);
+		}
 
-			m_fftPlan.Execute(m_filterCoeff.begin(), m_filterCoeff.end(), m_filterFreqResponse.begin());
+		// Design filters of requested ranges until the latest one has its filter, m_rangeMutex must be held.
+		// Task running already picks up the new request.
+		void StartFilterDesign()
+		{
+			if (m_filterDesignRunning)
+			{
+				return;
+			}
+
+			m_filterDesignRunning = true;
+
+			m_filterDesignTask = std::async(std::launch::async, [this]() {
+				std::unique_lock<std::mutex> lock{ m_rangeMutex };
+
+				while (!m_requestedRange.filter)
+				{
+					const DSP::FilterDesign design = GetFilterDesign(m_requestedRange.minFrequency, m_requestedRange.maxFrequency);
+
+					lock.unlock();
+					std::shared_ptr<const FilterResponse> filter = DesignFilter(design);
+					lock.lock();
+
+					m_filterCache.Insert(design, filter);
+
+					// Range may have been changed again in the meantime
+					if (design == GetFilterDesign(m_requestedRange.minFrequency, m_requestedRange.maxFrequency))
+					{
+						m_requestedRange.filter = std::move(filter);
+						m_requestedRangeReady.store(true, std::memory_order_release);
+					}
+				}
+
+				m_filterDesignRunning = false;
+			});
+		}
+
+		// Let the detector prepare for the settings changed since the previous frame, outside of Detect()
+		void ApplyDetectorSettings()
+		{
+			if (m_detectorSettingsChanged.exchange(false, std::memory_order_acquire))
+			{
+				m_detector.ApplySettings(GetDetectorSettings());
+			}
+		}
+
+		// Put the requested range in use, unless a setter holds the lock, then it is taken on the next frame.
+		// Previous filter is left in the request, so it is released by the setter.
+		void ApplyRequestedRange() noexcept
+		{
+			std::unique_lock<std::mutex> lock{ m_rangeMutex, std::try_to_lock };
+
+			if (lock)
+			{
+				m_minFrequency = m_requestedRange.minFrequency;
+				m_maxFrequency = m_requestedRange.maxFrequency;
+
+				if constexpr (s_usesFilteredPowerSpectrum)
+				{
+					m_filter.swap(m_requestedRange.filter);
+				}
+
+				m_requestedRangeReady.store(false, std::memory_order_relaxed);
+				m_detectorSettingsChanged.store(true, std::memory_order_relaxed);
+			}
 		}
 
 #ifdef CREATE_MATLAB_PLOTS
@@ -445,7 +1505,7 @@ namespace winrt::Tuner::implementation
 			using namespace winrt::Windows::Storage;
 
 			std::stringstream sstr;
-			sstr << "fs = " << m_samplingFrequency << ";" << std::endl;
+			sstr << "fs = " << GetAnalysisSamplingFrequency() << ";" << std::endl;
 			sstr << "filter_size = " << s_filterSize << ";" << std::endl;
 			sstr << "fft_size = " << s_fftResultSize << ";" << std::endl;
 			sstr << "time_step = 1 / fs;" << std::endl;
@@ -453,14 +1513,14 @@ namespace winrt::Tuner::implementation
 			sstr << "t = 0 : time_step : (filter_size - 1) * time_step;" << std::endl;
 			sstr << "n = 0 : freq_step : fs - freq_step;" << std::endl;
 			sstr << "filter = " << "[ ";
-			for (auto& val : m_filterCoeff) {
+			for (auto& val : m_filter->coefficients) {
 				sstr << val << " ";
 			}
 			sstr << " ];" << std::endl;
 
 			sstr << "filter_freq_response = " << "[ ";
-			for (auto& val : m_filterFreqResponse) {
-				sstr << 20.0f * std::log10(std::abs(val)) << " ";
+			for (auto& val : m_filter->powerResponse) {
+				sstr << 10.0f * std::log10(val) << " ";
 			}
 			sstr << " ];" << std::endl;
 			sstr << "subplot(2, 1, 1)" << std::endl;
@@ -484,8 +1544,8 @@ namespace winrt::Tuner::implementation
 			using namespace winrt::Windows::Storage;
 
 			std::stringstream sstr;
-			sstr << "fs = " << m_samplingFrequency << ";" << std::endl;
-			sstr << "input_size = " << s_audioBufferSize << ";" << std::endl;
+			sstr << "fs = " << GetAnalysisSamplingFrequency() << ";" << std::endl;
+			sstr << "input_size = " << s_analysisBufferSize << ";" << std::endl;
 			sstr << "fft_size = " << s_fftResultSize << ";" << std::endl;
 			sstr << "time_step = 1 / fs;" << std::endl;
 			sstr << "freq_step = fs / fft_size;" << std::endl;
@@ -493,7 +1553,7 @@ namespace winrt::Tuner::implementation
 			sstr << "n = 0 : freq_step : fs - freq_step;" << std::endl;
 
 			sstr << "input = " << "[ ";
-			auto audioBufferLast = audioBufferFirst + s_audioBufferSize;
+			auto audioBufferLast = audioBufferFirst + s_analysisBufferSize;
 			while (audioBufferFirst != audioBufferLast)
 			{
 				sstr << *audioBufferFirst << " ";
@@ -518,7 +1578,7 @@ namespace winrt::Tuner::implementation
 			sstr << "plot(n, spectrum)" << std::endl;
 			sstr << "xlabel('Frequency [Hz]')" << std::endl;
 			sstr << "ylabel('Magnitude [dB]')" << std::endl;
-			sstr << "title('Filtered input signal amplitude spectrum')" << std::endl;
+			sstr << "title('Input signal amplitude spectrum')" << std::endl;
 
 			StorageFolder storageFolder = ApplicationData::Current().LocalFolder();
 			StorageFile file = co_await storageFolder.CreateFileAsync(L"analysis_log.m", CreationCollisionOption::ReplaceExisting);
@@ -1,6 +1,12 @@
 #pragma once
+#include <cstddef>
+#include <type_traits>
+
 namespace winrt::Tuner::implementation
 {
+	// Assumed size of the cache line, used to keep data of different threads apart
+	inline constexpr size_t s_cacheLineSize{ 64U };
+
 	template<typename _Ty>
 	inline constexpr bool Is_positive_power_of_2(_Ty value)
 	{
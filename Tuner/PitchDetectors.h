@@ -0,0 +1,772 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "DSPMath.h"
+#include "FFTPlan.h"
+#include "GoertzelBank.h"
+#include "HarmonicProductSpectrum.h"
+#include "McLeodPitchMethod.h"
+#include "NoteLookup.h"
+#include "PeakInterpolation.h"
+#include "WindowGenerator.h"
+#include "WisdomStore.h"
+
+// Detector policies of PitchAnalyzer. Each one is a class template taking the sample type,
+// the audio buffer size and the FFT size used by the analyzer, and declaring what the analyzer
+// has to provide for it:
+//	s_usesSpectrum					- windowed forward FFT of the audio buffer, passed as SpectrumFrame
+//	s_usesFilteredPowerSpectrum		- power spectrum of the band-pass filtered buffer as well
+//	s_usesInverseFFT				- detector creates its own FFT plans in InitializeFFTPlans(), using
+//									  the wisdom store passed by the analyzer if any
+// Buffers and plans of unused stages are not allocated by the analyzer. Detect() returns
+// a PitchEstimate. ApplySettings() is called by the analyzer on initialization and between
+// frames when the settings passed to Detect() change, whatever depends on them is prepared
+// there, so Detect() does not allocate. It runs on the analysis thread and must not create FFT
+// plans, which would wait for the planner held by a background measure. Copies of a detector keep its settings but not the previous
+// frames, FFT plans of detectors declaring s_usesInverseFFT have to be initialized again.
+
+namespace winrt::Tuner::implementation
+{
+	// Parameters of the analysis passed to the detectors
+	struct DetectorSettings
+	{
+		float	samplingFrequency;
+		float	minFrequency;
+		float	maxFrequency;
+		// Number of samples between the starts of consecutive frames, 0 if unknown
+		size_t	hopSize;
+		// Frequency of A4 the notes are tuned to
+		float	baseToneFrequency;
+	};
+
+	// Result of a detector
+	struct PitchEstimate
+	{
+		// Fundamental frequency in Hz, 0 if none was found
+		float	frequency;
+		// How well the signal matches the detected pitch, in range [0, 1]
+		float	confidence;
+	};
+
+	// Spectrum computed by PitchAnalyzer for detectors declaring s_usesSpectrum
+	template<typename sample_t>
+	struct SpectrumFrame
+	{
+		// Spectrum of the windowed buffer
+		const std::complex<sample_t>*	spectrum;
+		// Power of the filtered spectrum in bins [0, binCount), may be overwritten by the detector
+		sample_t*						powerSpectrum;
+		// First and one past the last bin of the requested frequency range
+		size_t							minBin;
+		size_t							binCount;
+	};
+
+	// Period of the given frequency in samples, rounded up. Frequencies below 1 Hz are treated as 1 Hz.
+	inline size_t GetPeriodLength(float frequency, float samplingFrequency) noexcept
+	{
+		return static_cast<size_t>(std::ceil(samplingFrequency / std::max(frequency, 1.0f)));
+	}
+
+	// Harmonic Product Spectrum of the filtered log power spectrum, refined with Gaussian
+	// interpolation and, when consecutive frames overlap, with the phase vocoder
+	template<typename sample_t, size_t s_audioBufferSize, size_t s_fftSize>
+	class HarmonicProductSpectrumDetector
+	{
+		static constexpr size_t s_fftResultSize = s_fftSize / 2U + 1U;
+
+		using complex_t			= std::complex<sample_t>;
+		using FFTResultBuffer	= std::array<complex_t, s_fftResultSize>;
+
+		DSP::HarmonicProductSpectrum<sample_t> m_harmonicProductSpectrum;
+
+		// Spectrum of the previous frame in bins [m_previousBinFirst, m_previousBinLast),
+		// its phases are used for the phase vocoder refinement
+		FFTResultBuffer	m_previousSpectrum;
+		size_t			m_previousBinFirst;
+		size_t			m_previousBinLast;
+
+	public:
+
+		static constexpr bool s_usesSpectrum				= true;
+		static constexpr bool s_usesFilteredPowerSpectrum	= true;
+		static constexpr bool s_usesInverseFFT				= false;
+
+		HarmonicProductSpectrumDetector() :
+			m_harmonicProductSpectrum	{ s_fftResultSize },
+			m_previousBinFirst			{ 0U },
+			m_previousBinLast			{ 0U }
+		{
+		}
+
+		HarmonicProductSpectrumDetector(const HarmonicProductSpectrumDetector& other) :
+			m_harmonicProductSpectrum	{ other.m_harmonicProductSpectrum },
+			m_previousBinFirst			{ 0U },
+			m_previousBinLast			{ 0U }
+		{
+		}
+
+		HarmonicProductSpectrumDetector& operator=(const HarmonicProductSpectrumDetector&) = delete;
+
+		// Set number of harmonics combined for each candidate, at least 1
+		void SetHarmonicCount(size_t harmonicCount)
+		{
+			m_harmonicProductSpectrum.SetHarmonicCount(harmonicCount);
+		}
+
+		size_t GetHarmonicCount() const noexcept
+		{
+			return m_harmonicProductSpectrum.GetHarmonicCount();
+		}
+
+		// Number of the newest samples the detection is based on
+		size_t GetWindowSize() const noexcept
+		{
+			return s_audioBufferSize;
+		}
+
+		// Forget the previous frame, e.g. after a gap in the input signal
+		void Reset() noexcept
+		{
+			m_previousBinFirst	= 0U;
+			m_previousBinLast	= 0U;
+		}
+
+		// Settings are read by Detect() as they are
+		void ApplySettings(const DetectorSettings&) noexcept
+		{
+		}
+
+		// Confidence is the fraction of the filtered power found around the harmonics of the fundamental
+		PitchEstimate Detect(const SpectrumFrame<sample_t>& frame, const DetectorSettings& settings) noexcept
+		{
+			const size_t minBin			= frame.minBin;
+			const size_t binCount		= frame.binCount;
+			sample_t* powerSpectrum		= frame.powerSpectrum;
+
+			const sample_t totalPower	= std::accumulate(std::next(powerSpectrum, std::min(minBin, binCount)), std::next(powerSpectrum, binCount), static_cast<sample_t>(0));
+
+			// Logarithmic scale turns the product of harmonics into a sum, which cannot underflow
+			if (minBin < binCount)
+			{
+				DSP::Logarithm(std::next(powerSpectrum, minBin), std::next(powerSpectrum, binCount), std::next(powerSpectrum, minBin));
+			}
+
+			const size_t fundamentalBin	= m_harmonicProductSpectrum.FindFundamental(powerSpectrum, std::next(powerSpectrum, binCount), minBin);
+			const double refinedBin		= RefineFundamental(frame, fundamentalBin, settings.hopSize);
+
+			// Keep phases of the current frame for the next one
+			if (minBin < binCount)
+			{
+				std::copy(std::next(frame.spectrum, minBin), std::next(frame.spectrum, binCount), std::next(m_previousSpectrum.begin(), minBin));
+				m_previousBinFirst	= minBin;
+				m_previousBinLast	= binCount;
+			}
+
+			return {
+				static_cast<float>(refinedBin * static_cast<double>(settings.samplingFrequency) / static_cast<double>(s_fftSize)),
+				GetHarmonicPowerRatio(frame, refinedBin, totalPower)
+			};
+		}
+
+	private:
+
+		// Fraction of the total power in bins next to the harmonics of the fundamental, the power
+		// spectrum is already in logarithmic scale
+		float GetHarmonicPowerRatio(const SpectrumFrame<sample_t>& frame, double fundamentalBin, sample_t totalPower) const noexcept
+		{
+			if (!(fundamentalBin > 0.0) || !(totalPower > static_cast<sample_t>(0)))
+			{
+				return 0.0f;
+			}
+
+			sample_t harmonicPower	= static_cast<sample_t>(0);
+			// Next bin not summed yet, neighbourhoods of harmonics of a low fundamental may overlap
+			size_t nextBin			= frame.minBin;
+
+			for (size_t harmonic = 1U; harmonic <= m_harmonicProductSpectrum.GetHarmonicCount(); harmonic++)
+			{
+				const size_t bin = static_cast<size_t>(std::lround(static_cast<double>(harmonic) * fundamentalBin));
+
+				if (bin >= frame.binCount)
+				{
+					break;
+				}
+
+				for (size_t index = std::max(nextBin, bin > 0U ? bin - 1U : 0U); index <= bin + 1U && index < frame.binCount; index++)
+				{
+					harmonicPower += std::exp(frame.powerSpectrum[index]);
+				}
+
+				nextBin = std::max(nextBin, bin + 2U);
+			}
+
+			return static_cast<float>(std::min(harmonicPower / totalPower, static_cast<sample_t>(1)));
+		}
+
+		// Find the position of the fundamental with sub-bin accuracy. Gaussian interpolation of the
+		// unfiltered spectrum gives an estimate within a fraction of a bin, which the phase vocoder
+		// refines further if the previous frame is available. The filter slope would bias the
+		// interpolation near the edges of the frequency range.
+		double RefineFundamental(const SpectrumFrame<sample_t>& frame, size_t bin, size_t hopSize) const noexcept
+		{
+			// Largest accepted difference between the two estimates, in bins. Larger one means the
+			// frames were not consecutive or the tone has changed.
+			constexpr double maxPhaseVocoderCorrection = 1.0;
+
+			if (bin == 0U)
+			{
+				return 0.0;
+			}
+
+			const sample_t* logPower	= frame.powerSpectrum;
+			const complex_t* spectrum	= frame.spectrum;
+
+			// Maximum of the harmonic product may be next to the peak of the fundamental itself
+			size_t peak = bin;
+
+			if (peak > frame.minBin && logPower[peak - 1U] > logPower[peak])
+			{
+				peak--;
+			}
+			else if (peak + 1U < frame.binCount && logPower[peak + 1U] > logPower[peak])
+			{
+				peak++;
+			}
+
+			double estimate = static_cast<double>(peak);
+
+			if (peak > 0U && peak + 1U < s_fftResultSize)
+			{
+				auto logNorm = [spectrum](size_t index) {
+					return std::log(std::max(std::norm(spectrum[index]), std::numeric_limits<sample_t>::min()));
+				};
+
+				estimate += static_cast<double>(DSP::GaussianPeakOffset(logNorm(peak - 1U), logNorm(peak), logNorm(peak + 1U)));
+			}
+
+			if (hopSize > 0U && peak >= m_previousBinFirst && peak < m_previousBinLast)
+			{
+				const double refined = DSP::PhaseVocoderFrequency(
+					static_cast<double>(std::arg(m_previousSpectrum[peak])),
+					static_cast<double>(std::arg(spectrum[peak])),
+					peak,
+					hopSize,
+					s_fftSize);
+
+				if (std::abs(refined - estimate) < maxPhaseVocoderCorrection)
+				{
+					estimate = refined;
+				}
+			}
+
+			return estimate;
+		}
+	};
+
+	// McLeod Pitch Method on the newest few periods of the lowest tone, lower latency than
+	// the spectral detectors. Does not use the band-pass filter.
+	template<typename sample_t, size_t s_audioBufferSize, size_t s_fftSize>
+	class McLeodPitchMethodDetector
+	{
+		static constexpr size_t s_minWindowSize{ 4U };
+
+		// Power of 2 window sizes from s_minWindowSize up to the first one holding the audio buffer
+		static constexpr size_t s_windowSizeCount = []() {
+			size_t count = 1U;
+
+			for (size_t windowSize = s_minWindowSize; windowSize < s_audioBufferSize; windowSize *= 2U)
+			{
+				count++;
+			}
+
+			return count;
+		}();
+
+		// Detectors of every window size the settings may choose, created up front so that a change
+		// of the settings only selects one
+		std::array<DSP::McLeodPitchMethod<sample_t>, s_windowSizeCount> m_mcleodPitchMethods;
+		size_t m_windowIndex;
+
+		// Kept for the plans created later
+		sample_t m_threshold;
+
+	public:
+
+		static constexpr bool s_usesSpectrum				= false;
+		static constexpr bool s_usesFilteredPowerSpectrum	= false;
+		static constexpr bool s_usesInverseFFT				= true;
+
+		// Number of periods of the lowest tone in the analyzed window
+		static constexpr size_t s_periodsPerWindow{ 3U };
+
+		McLeodPitchMethodDetector() :
+			m_windowIndex	{ 0U },
+			m_threshold		{ DSP::McLeodPitchMethod<sample_t>::s_defaultThreshold }
+		{
+		}
+
+		McLeodPitchMethodDetector(const McLeodPitchMethodDetector& other) :
+			m_windowIndex	{ other.m_windowIndex },
+			m_threshold		{ other.m_threshold }
+		{
+		}
+
+		McLeodPitchMethodDetector& operator=(const McLeodPitchMethodDetector&) = delete;
+
+		// Set fraction of the highest NSDF maximum the chosen one must reach, in range (0, 1]
+		void SetThreshold(sample_t threshold)
+		{
+			for (auto& mcleodPitchMethod : m_mcleodPitchMethods)
+			{
+				mcleodPitchMethod.SetThreshold(threshold);
+			}
+
+			m_threshold = threshold;
+		}
+
+		// Number of the newest samples the detection is based on, known after InitializeFFTPlans()
+		size_t GetWindowSize() const noexcept
+		{
+			return m_mcleodPitchMethods[m_windowIndex].GetWindowSize();
+		}
+
+		void Reset() noexcept
+		{
+		}
+
+		// Window follows the lowest frequency
+		void ApplySettings(const DetectorSettings& settings) noexcept
+		{
+			m_windowIndex = ChooseWindowIndex(settings);
+		}
+
+		bool IsFFTPlanCreated() const noexcept
+		{
+			return std::all_of(m_mcleodPitchMethods.begin(), m_mcleodPitchMethods.end(), [](const auto& mcleodPitchMethod) {
+				return static_cast<bool>(mcleodPitchMethod);
+			});
+		}
+
+		// Create FFT plans of every window size. Plans of the power of 2 window holding s_periodsPerWindow
+		// periods of the lowest tone are taken from wisdom or, if not available, measured and their wisdom
+		// is saved to the store. Other sizes are estimated if there is no wisdom.
+		// Returns true if plans were measured.
+		bool InitializeFFTPlans(const DetectorSettings& settings, const DSP::WisdomStore<sample_t>* wisdomStore = nullptr)
+		{
+			m_windowIndex	= ChooseWindowIndex(settings);
+			bool measured	= false;
+
+			for (size_t windowIndex = 0U; windowIndex < s_windowSizeCount; windowIndex++)
+			{
+				const size_t windowSize = s_minWindowSize << windowIndex;
+
+				// Autocorrelation of the window zero-padded to twice its length
+				const DSP::WisdomKey forwardKey{ DSP::transform::r2c, 2U * windowSize };
+				const DSP::WisdomKey inverseKey{ DSP::transform::c2r, 2U * windowSize };
+
+				if (wisdomStore)
+				{
+					wisdomStore->Load(forwardKey);
+					wisdomStore->Load(inverseKey);
+				}
+
+				auto& mcleodPitchMethod = m_mcleodPitchMethods[windowIndex];
+				mcleodPitchMethod		= DSP::McLeodPitchMethod<sample_t>(windowSize, DSP::flags::wisdom);
+
+				if (!mcleodPitchMethod && windowIndex == m_windowIndex)
+				{
+					mcleodPitchMethod	= DSP::McLeodPitchMethod<sample_t>(windowSize, DSP::flags::measure);
+					measured			= true;
+
+					if (wisdomStore)
+					{
+						wisdomStore->Save(forwardKey);
+						wisdomStore->Save(inverseKey);
+					}
+				}
+				else if (!mcleodPitchMethod)
+				{
+					mcleodPitchMethod = DSP::McLeodPitchMethod<sample_t>(windowSize, DSP::flags::estimate);
+				}
+
+				mcleodPitchMethod.SetThreshold(m_threshold);
+			}
+
+			return measured;
+		}
+
+		// Confidence is the clarity of the chosen NSDF maximum
+		template<typename _FwdIt>
+		PitchEstimate Detect(_FwdIt first, _FwdIt last, const DetectorSettings& settings) noexcept
+		{
+			// Only the newest samples are analyzed
+			auto& mcleodPitchMethod	= m_mcleodPitchMethods[m_windowIndex];
+			const size_t windowSize	= mcleodPitchMethod.GetWindowSize();
+			const auto period		= mcleodPitchMethod.FindPeriod(
+				std::next(first, s_audioBufferSize - windowSize),
+				last,
+				GetPeriodLength(settings.maxFrequency, settings.samplingFrequency),
+				GetPeriodLength(settings.minFrequency, settings.samplingFrequency) + 1U);
+
+			if (period.period > 0.0)
+			{
+				return {
+					static_cast<float>(static_cast<double>(settings.samplingFrequency) / period.period),
+					std::clamp(static_cast<float>(period.clarity), 0.0f, 1.0f)
+				};
+			}
+
+			return { 0.0f, 0.0f };
+		}
+
+	private:
+
+		// Index of the power of 2 window holding s_periodsPerWindow periods of the lowest tone, at most
+		// the first one holding the audio buffer
+		static size_t ChooseWindowIndex(const DetectorSettings& settings) noexcept
+		{
+			const size_t minWindowSize = s_periodsPerWindow * GetPeriodLength(settings.minFrequency, settings.samplingFrequency);
+
+			size_t windowIndex = 0U;
+
+			while (windowIndex + 1U < s_windowSizeCount && (s_minWindowSize << windowIndex) < minWindowSize)
+			{
+				windowIndex++;
+			}
+
+			return windowIndex;
+		}
+	};
+
+	// Tuning to a few target notes, by default the open strings of a guitar in standard tuning. Instead of
+	// the whole spectrum, a Goertzel bank evaluates only the bins within s_maxDeviationCents of each target
+	// and of its harmonics, so a frame costs a few multiply-adds per sample and bin. The target whose
+	// harmonics hold the most power is chosen and its frequency is interpolated at its strongest harmonic.
+	// Pitch further than s_maxDeviationCents from every target is not reported.
+	template<typename sample_t, size_t s_audioBufferSize, size_t s_fftSize>
+	class TargetNoteDetector
+	{
+		// Goertzel recurrence loses precision in float at low frequencies, the bank runs in double
+		using compute_t = double;
+
+		// Consecutive bins around a harmonic of a target, bins [firstBin, firstBin + binCount) of an
+		// s_audioBufferSize-point DFT at position first of the bank
+		struct HarmonicBins
+		{
+			size_t	first;
+			size_t	firstBin;
+			size_t	binCount;
+			size_t	harmonic;
+		};
+
+		// Target note and its harmonics [firstHarmonic, lastHarmonic) of m_harmonicBins
+		struct Target
+		{
+			int		midiNote;
+			float	frequency;
+			size_t	firstHarmonic;
+			size_t	lastHarmonic;
+		};
+
+		std::vector<int>			m_targetNotes;
+		size_t						m_harmonicCount;
+
+		// Bins of the targets for the settings in m_layoutSettings, rebuilt when they or the targets change
+		std::vector<Target>			m_targets;
+		std::vector<HarmonicBins>	m_harmonicBins;
+		DSP::GoertzelBank<compute_t>	m_bank;
+		DetectorSettings			m_layoutSettings;
+		bool						m_layoutValid;
+
+		std::vector<compute_t>		m_window;
+		std::vector<compute_t>		m_windowedInput;
+		std::vector<compute_t>		m_power;
+
+	public:
+
+		static constexpr bool s_usesSpectrum				= false;
+		static constexpr bool s_usesFilteredPowerSpectrum	= false;
+		static constexpr bool s_usesInverseFFT				= false;
+
+		static constexpr size_t s_defaultHarmonicCount{ 3U };
+		static constexpr float s_maxDeviationCents{ 50.0f };
+
+		TargetNoteDetector() :
+			m_targetNotes	( s_standardGuitarTuning.begin(), s_standardGuitarTuning.end() ),
+			m_harmonicCount	{ s_defaultHarmonicCount },
+			m_layoutSettings{},
+			m_layoutValid	{ false },
+			m_window		( s_audioBufferSize ),
+			m_windowedInput	( s_audioBufferSize )
+		{
+			DSP::WindowGenerator::Generate(DSP::WindowGenerator::WindowType::BlackmanHarris, m_window.begin(), m_window.end());
+		}
+
+		TargetNoteDetector(const TargetNoteDetector&) = default;
+		TargetNoteDetector& operator=(const TargetNoteDetector&) = delete;
+
+		// Set the notes to tune to as MIDI note numbers, 40 for E2. Not synchronized with Detect().
+		template<typename _InIt>
+		void SetTargetNotes(_InIt first, _InIt last)
+		{
+			m_targetNotes.assign(first, last);
+
+			if (m_layoutValid)
+			{
+				BuildLayout(m_layoutSettings);
+			}
+		}
+
+		const std::vector<int>& GetTargetNotes() const noexcept
+		{
+			return m_targetNotes;
+		}
+
+		// Set number of harmonics of each target evaluated, at least 1
+		void SetHarmonicCount(size_t harmonicCount)
+		{
+			if (harmonicCount == 0U)
+			{
+				throw std::invalid_argument("Harmonic count must be positive.");
+			}
+
+			m_harmonicCount = harmonicCount;
+
+			if (m_layoutValid)
+			{
+				BuildLayout(m_layoutSettings);
+			}
+		}
+
+		size_t GetHarmonicCount() const noexcept
+		{
+			return m_harmonicCount;
+		}
+
+		// Get number of frequencies the Goertzel bank evaluates, known after the settings are applied
+		size_t GetBinCount() const noexcept
+		{
+			return m_bank.GetSize();
+		}
+
+		size_t GetWindowSize() const noexcept
+		{
+			return s_audioBufferSize;
+		}
+
+		void Reset() noexcept
+		{
+		}
+
+		// Bins of the targets depend on all the settings but the hop size
+		void ApplySettings(const DetectorSettings& settings)
+		{
+			if (!m_layoutValid || !IsSameLayout(settings))
+			{
+				BuildLayout(settings);
+			}
+		}
+
+		// Confidence is the fraction of the evaluated power found at the harmonics of the chosen target.
+		// Bins are those chosen by ApplySettings(), none before it is called.
+		template<typename _FwdIt>
+		PitchEstimate Detect(_FwdIt first, _FwdIt last, const DetectorSettings& settings) noexcept
+		{
+			static_cast<void>(last);
+
+			if (m_bank.GetSize() == 0U)
+			{
+				return { 0.0f, 0.0f };
+			}
+
+			for (size_t n = 0U; n < s_audioBufferSize; n++, ++first)
+			{
+				m_windowedInput[n] = static_cast<compute_t>(*first) * m_window[n];
+			}
+
+			m_bank.Power(m_windowedInput.data(), m_windowedInput.data() + s_audioBufferSize, m_power.begin());
+
+			// Sum over the unique bins, harmonics of different targets may share them
+			const compute_t totalPower = std::accumulate(m_power.begin(), m_power.end(), static_cast<compute_t>(0));
+
+			const Target* bestTarget	= nullptr;
+			compute_t bestScore			= static_cast<compute_t>(0);
+
+			for (const Target& target : m_targets)
+			{
+				compute_t score = static_cast<compute_t>(0);
+
+				for (size_t harmonic = target.firstHarmonic; harmonic < target.lastHarmonic; harmonic++)
+				{
+					score += GetPeakPower(m_harmonicBins[harmonic]);
+				}
+
+				if (score > bestScore)
+				{
+					bestScore	= score;
+					bestTarget	= &target;
+				}
+			}
+
+			if (!bestTarget || !(totalPower > static_cast<compute_t>(0)))
+			{
+				return { 0.0f, 0.0f };
+			}
+
+			const float frequency = GetHarmonicFrequency(*bestTarget, settings.samplingFrequency);
+
+			if (!(frequency > 0.0f) || std::abs(1200.0f * std::log2(frequency / bestTarget->frequency)) > s_maxDeviationCents)
+			{
+				return { 0.0f, 0.0f };
+			}
+
+			return { frequency, static_cast<float>(std::min(bestScore / totalPower, static_cast<compute_t>(1))) };
+		}
+
+	private:
+
+		bool IsSameLayout(const DetectorSettings& settings) const noexcept
+		{
+			return settings.samplingFrequency == m_layoutSettings.samplingFrequency && settings.minFrequency == m_layoutSettings.minFrequency &&
+				settings.maxFrequency == m_layoutSettings.maxFrequency && settings.baseToneFrequency == m_layoutSettings.baseToneFrequency;
+		}
+
+		// Choose the bins of each target in the requested range. Bins of a harmonic cover s_maxDeviationCents
+		// on both sides of it and one more bin on each side for the interpolation.
+		void BuildLayout(const DetectorSettings& settings)
+		{
+			const double binWidth		= static_cast<double>(settings.samplingFrequency) / static_cast<double>(s_audioBufferSize);
+			const double maxDeviation	= std::exp2(static_cast<double>(s_maxDeviationCents) / 1200.0);
+			const size_t lastBin		= s_audioBufferSize / 2U - 1U;
+
+			m_targets.clear();
+			m_harmonicBins.clear();
+			std::vector<size_t> bins;
+
+			for (const int midiNote : m_targetNotes)
+			{
+				const float frequency = GetNoteFrequency(midiNote, settings.baseToneFrequency);
+
+				if (frequency < settings.minFrequency || frequency > settings.maxFrequency)
+				{
+					continue;
+				}
+
+				Target target{ midiNote, frequency, m_harmonicBins.size(), m_harmonicBins.size() };
+
+				for (size_t harmonic = 1U; harmonic <= m_harmonicCount; harmonic++)
+				{
+					const double center		= static_cast<double>(harmonic) * static_cast<double>(frequency) / binWidth;
+					const double lowBin		= std::floor(center / maxDeviation) - 1.0;
+					const double highBin	= std::ceil(center * maxDeviation) + 1.0;
+
+					if (lowBin < 1.0 || highBin > static_cast<double>(lastBin))
+					{
+						break;
+					}
+
+					const size_t firstBin = static_cast<size_t>(lowBin);
+					const size_t binCount = static_cast<size_t>(highBin) - firstBin + 1U;
+
+					m_harmonicBins.push_back({ 0U, firstBin, binCount, harmonic });
+
+					for (size_t bin = firstBin; bin < firstBin + binCount; bin++)
+					{
+						bins.push_back(bin);
+					}
+				}
+
+				target.lastHarmonic = m_harmonicBins.size();
+
+				if (target.lastHarmonic > target.firstHarmonic)
+				{
+					m_targets.push_back(target);
+				}
+			}
+
+			// Each bin is evaluated once, bins of a harmonic stay consecutive in the sorted list
+			std::sort(bins.begin(), bins.end());
+			bins.erase(std::unique(bins.begin(), bins.end()), bins.end());
+
+			for (HarmonicBins& harmonicBins : m_harmonicBins)
+			{
+				harmonicBins.first = static_cast<size_t>(std::distance(bins.begin(), std::lower_bound(bins.begin(), bins.end(), harmonicBins.firstBin)));
+			}
+
+			std::vector<double> frequencies(bins.size());
+			std::transform(bins.begin(), bins.end(), frequencies.begin(), [](size_t bin) {
+				return static_cast<double>(bin) / static_cast<double>(s_audioBufferSize);
+			});
+
+			m_bank = DSP::GoertzelBank<compute_t>(frequencies.begin(), frequencies.end());
+			m_power.resize(bins.size());
+			m_layoutSettings	= settings;
+			m_layoutValid		= true;
+		}
+
+		// Index of the highest bin of a harmonic, relative to its first one
+		size_t FindPeak(const HarmonicBins& harmonicBins) const noexcept
+		{
+			const auto first = std::next(m_power.begin(), harmonicBins.first);
+			return static_cast<size_t>(std::distance(first, std::max_element(first, std::next(first, harmonicBins.binCount))));
+		}
+
+		// Power of the highest bin of a harmonic and of its neighbours, the peak of a tone between bins
+		// is spread over them
+		compute_t GetPeakPower(const HarmonicBins& harmonicBins) const noexcept
+		{
+			const size_t peak	= FindPeak(harmonicBins);
+			const size_t first	= harmonicBins.first + (peak > 0U ? peak - 1U : 0U);
+			const size_t last	= harmonicBins.first + std::min(peak + 2U, harmonicBins.binCount);
+
+			return std::accumulate(std::next(m_power.begin(), first), std::next(m_power.begin(), last), static_cast<compute_t>(0));
+		}
+
+		// Fundamental from the Gaussian interpolation of the strongest harmonic of the target, 0 if its peak
+		// is at the edge of its bins, i.e. the tone is too far from the target
+		float GetHarmonicFrequency(const Target& target, float samplingFrequency) const noexcept
+		{
+			const HarmonicBins* strongest	= nullptr;
+			compute_t strongestPower		= static_cast<compute_t>(0);
+
+			for (size_t harmonic = target.firstHarmonic; harmonic < target.lastHarmonic; harmonic++)
+			{
+				const HarmonicBins& harmonicBins	= m_harmonicBins[harmonic];
+				const compute_t power				= m_power[harmonicBins.first + FindPeak(harmonicBins)];
+
+				if (power > strongestPower)
+				{
+					strongestPower	= power;
+					strongest		= &harmonicBins;
+				}
+			}
+
+			if (!strongest)
+			{
+				return 0.0f;
+			}
+
+			const size_t peak = FindPeak(*strongest);
+
+			if (peak == 0U || peak + 1U == strongest->binCount)
+			{
+				return 0.0f;
+			}
+
+			auto logPower = [this, strongest](size_t index) {
+				return std::log(std::max(m_power[strongest->first + index], std::numeric_limits<compute_t>::min()));
+			};
+
+			const double bin = static_cast<double>(strongest->firstBin + peak) + DSP::GaussianPeakOffset(logPower(peak - 1U), logPower(peak), logPower(peak + 1U));
+
+			return static_cast<float>(bin * static_cast<double>(samplingFrequency) / static_cast<double>(s_audioBufferSize * strongest->harmonic));
+		}
+	};
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "PitchAnalyzerTraits.h"
+
+namespace winrt::Tuner::implementation
+{
+	// Wait-free single-producer/single-consumer ring buffer of samples. Push() may be called
+	// from one thread and Pop() from another one, neither of them ever blocks. When there is
+	// not enough free space, pushed samples are dropped and the overrun is counted.
+	template<typename _Ty, size_t s_capacity>
+	class SampleRingBuffer
+	{
+		static_assert(Is_positive_power_of_2(s_capacity), "Capacity must be a power of 2.");
+
+		static constexpr size_t s_indexMask{ s_capacity - 1U };
+
+		// Total number of samples written, modified only by the producer
+		alignas(s_cacheLineSize) std::atomic<size_t>	m_head;
+		// Number of rejected pushes and samples lost because of them
+		std::atomic<uint64_t>							m_overrunCount;
+		std::atomic<uint64_t>							m_droppedSampleCount;
+
+		// Total number of samples read, modified only by the consumer
+		alignas(s_cacheLineSize) std::atomic<size_t>	m_tail;
+
+		alignas(s_cacheLineSize) std::array<_Ty, s_capacity> m_buffer;
+
+	public:
+
+		SampleRingBuffer() :
+			m_head					{ 0U },
+			m_overrunCount			{ 0U },
+			m_droppedSampleCount	{ 0U },
+			m_tail					{ 0U }
+		{
+			m_buffer.fill(static_cast<_Ty>(0));
+		}
+
+		SampleRingBuffer(SampleRingBuffer&&)					= delete;
+		SampleRingBuffer(const SampleRingBuffer&)				= delete;
+		SampleRingBuffer& operator=(SampleRingBuffer&&)			= delete;
+		SampleRingBuffer& operator=(const SampleRingBuffer&)	= delete;
+
+		// Producer side. Either all samples are written or none of them are.
+		template<typename _InIt>
+		bool Push(_InIt first, _InIt last) noexcept
+		{
+			const size_t count	= static_cast<size_t>(std::distance(first, last));
+			const size_t head	= m_head.load(std::memory_order_relaxed);
+			const size_t tail	= m_tail.load(std::memory_order_acquire);
+
+			if (s_capacity - (head - tail) < count)
+			{
+				m_overrunCount.fetch_add(1U, std::memory_order_relaxed);
+				m_droppedSampleCount.fetch_add(count, std::memory_order_relaxed);
+				return false;
+			}
+
+			// Data wraps around the end of the buffer at most once
+			const size_t position		= head & s_indexMask;
+			const size_t firstPartSize	= std::min(count, s_capacity - position);
+
+			auto middle = std::next(first, firstPartSize);
+			std::copy(first, middle, std::next(m_buffer.begin(), position));
+			std::copy(middle, last, m_buffer.begin());
+
+			m_head.store(head + count, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer side. Copies exactly count samples to dest, or nothing when fewer are available.
+		template<typename _OutIt>
+		bool Pop(_OutIt dest, size_t count) noexcept
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			const size_t head = m_head.load(std::memory_order_acquire);
+
+			if (head - tail < count)
+			{
+				return false;
+			}
+
+			const size_t position		= tail & s_indexMask;
+			const size_t firstPartSize	= std::min(count, s_capacity - position);
+
+			auto bufferFirst = m_buffer.begin();
+			dest = std::copy(std::next(bufferFirst, position), std::next(bufferFirst, position + firstPartSize), dest);
+			std::copy(bufferFirst, std::next(bufferFirst, count - firstPartSize), dest);
+
+			m_tail.store(tail + count, std::memory_order_release);
+			return true;
+		}
+
+		// Number of samples available to the consumer
+		size_t Size() const noexcept
+		{
+			const size_t tail = m_tail.load(std::memory_order_acquire);
+			const size_t head = m_head.load(std::memory_order_acquire);
+			return head - tail;
+		}
+
+		static constexpr size_t Capacity() noexcept
+		{
+			return s_capacity;
+		}
+
+		// Number of pushes rejected because the consumer did not keep up
+		uint64_t GetOverrunCount() const noexcept
+		{
+			return m_overrunCount.load(std::memory_order_relaxed);
+		}
+
+		// Number of samples lost due to overruns
+		uint64_t GetDroppedSampleCount() const noexcept
+		{
+			return m_droppedSampleCount.load(std::memory_order_relaxed);
+		}
+	};
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#if defined __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined _WIN32
+#include <windows.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace winrt::Tuner::implementation
+{
+	// Counting semaphore which sleeps in the kernel only when there is nothing to acquire.
+	// Waiting is backed by futex on Linux and WaitOnAddress on Windows, other platforms
+	// fall back to a condition variable.
+	class Semaphore
+	{
+		// 32-bit counter is used directly as the futex word
+		std::atomic<int32_t> m_count;
+		// Number of threads sleeping in Acquire(), lets Release() skip the system call
+		std::atomic<int32_t> m_waiterCount;
+
+#if !defined __linux__ && !defined _WIN32
+		std::mutex				m_mutex;
+		std::condition_variable	m_condition;
+#endif
+
+		// Sleep as long as the counter equals zero
+		void WaitWhileZero() noexcept
+		{
+#if defined __linux__
+			syscall(SYS_futex, reinterpret_cast<int32_t*>(&m_count), FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+#elif defined _WIN32
+			int32_t zero = 0;
+			WaitOnAddress(&m_count, &zero, sizeof(zero), INFINITE);
+#else
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]() { return m_count.load() != 0; });
+#endif
+		}
+
+		void WakeOne() noexcept
+		{
+#if defined __linux__
+			syscall(SYS_futex, reinterpret_cast<int32_t*>(&m_count), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#elif defined _WIN32
+			WakeByAddressSingle(&m_count);
+#else
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_condition.notify_one();
+#endif
+		}
+
+	public:
+
+		explicit Semaphore(int32_t initialCount = 0) : m_count{ initialCount }, m_waiterCount{ 0 }
+		{
+			static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "Atomic counter cannot be used as a futex word.");
+		}
+
+		Semaphore(Semaphore&&)					= delete;
+		Semaphore(const Semaphore&)				= delete;
+		Semaphore& operator=(Semaphore&&)		= delete;
+		Semaphore& operator=(const Semaphore&)	= delete;
+
+		// Increment the counter and wake one waiting thread, if any
+		void Release() noexcept
+		{
+			m_count.fetch_add(1);
+
+			if (m_waiterCount.load() > 0)
+			{
+				WakeOne();
+			}
+		}
+
+		// Decrement the counter, sleep while it equals zero
+		void Acquire() noexcept
+		{
+			while (!TryAcquire())
+			{
+				m_waiterCount.fetch_add(1);
+				WaitWhileZero();
+				m_waiterCount.fetch_sub(1);
+			}
+		}
+
+		// Decrement the counter if it is positive, never sleeps
+		bool TryAcquire() noexcept
+		{
+			int32_t count = m_count.load(std::memory_order_relaxed);
+
+			while (count > 0)
+			{
+				if (m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+	};
+}
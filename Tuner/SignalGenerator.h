@@ -0,0 +1,135 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <vector>
+#include "OfflineAudioSource.h"
+
+namespace winrt::Tuner::implementation
+{
+	// Offline audio source producing a mix of sines, harmonic stacks and white noise
+	class SignalGenerator : public OfflineAudioSource
+	{
+		struct Oscillator
+		{
+			double frequency;
+			double amplitude;
+			double initialPhase;
+			double phase;
+		};
+
+		struct NoiseSource
+		{
+			double			amplitude;
+			uint32_t		seed;
+			std::mt19937	engine;
+		};
+
+		static constexpr double s_twoPi{ 6.283185307179586476925286766559 };
+
+		std::vector<Oscillator>		oscillators;
+		std::vector<NoiseSource>	noiseSources;
+
+		// Total length of the generated signal and the position in it
+		size_t sampleCount;
+		size_t position;
+
+	protected:
+
+		size_t ReadSamples(sample_t* dest, size_t count) override
+		{
+			count = (position < sampleCount) ? std::min(count, sampleCount - position) : 0U;
+			Generate(dest, dest + count);
+			return count;
+		}
+
+		void Rewind() override
+		{
+			position = 0U;
+
+			for (Oscillator& oscillator : oscillators)
+			{
+				oscillator.phase = oscillator.initialPhase;
+			}
+
+			for (NoiseSource& noise : noiseSources)
+			{
+				noise.engine.seed(noise.seed);
+			}
+		}
+
+	public:
+
+		// Generator of sampleCount samples at the given sample rate
+		SignalGenerator(uint32_t sampleRate, size_t sampleCount) :
+			OfflineAudioSource	{ sampleRate },
+			sampleCount			{ sampleCount },
+			position			{ 0U }
+		{
+		}
+
+		// Add a sine wave, phase in radians
+		void AddSine(double frequency, double amplitude, double phase = 0.0)
+		{
+			oscillators.push_back({ frequency, amplitude, phase, phase });
+		}
+
+		// Add a fundamental and its harmonicCount - 1 overtones, amplitude
+		// of each overtone is the amplitude of the previous one times rolloff
+		void AddHarmonics(double fundamental, size_t harmonicCount, double amplitude, double rolloff = 0.5)
+		{
+			for (size_t n = 1U; n <= harmonicCount; n++)
+			{
+				AddSine(fundamental * static_cast<double>(n), amplitude);
+				amplitude *= rolloff;
+			}
+		}
+
+		// Add uniformly distributed white noise in range [-amplitude, amplitude]
+		void AddNoise(double amplitude, uint32_t seed = 0U)
+		{
+			noiseSources.push_back({ amplitude, seed, std::mt19937(seed) });
+		}
+
+		// Remove all components
+		void Clear() noexcept
+		{
+			oscillators.clear();
+			noiseSources.clear();
+		}
+
+		// Get current bit depth
+		uint32_t GetBitDepth() const noexcept override
+		{
+			return 8U * sizeof(sample_t);
+		}
+
+		// Write the following samples of the signal to [first, last), regardless of the signal length
+		template<typename _OutIt>
+		void Generate(_OutIt first, _OutIt last)
+		{
+			using value_t = typename std::iterator_traits<_OutIt>::value_type;
+
+			const double samplingPeriod = 1.0 / static_cast<double>(GetSampleRate());
+
+			for (; first != last; ++first)
+			{
+				double value = 0.0;
+
+				for (Oscillator& oscillator : oscillators)
+				{
+					value += oscillator.amplitude * std::sin(oscillator.phase);
+					oscillator.phase = std::fmod(oscillator.phase + s_twoPi * oscillator.frequency * samplingPeriod, s_twoPi);
+				}
+
+				for (NoiseSource& noise : noiseSources)
+				{
+					std::uniform_real_distribution<double> distribution(-noise.amplitude, noise.amplitude);
+					value += distribution(noise.engine);
+				}
+
+				*first = static_cast<value_t>(value);
+				position++;
+			}
+		}
+	};
+}
@@ -0,0 +1,269 @@
+#pragma once
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include "OfflineAudioSource.h"
+
+namespace winrt::Tuner::implementation
+{
+	// Offline audio source reading RIFF/WAVE files or headerless PCM data. Integer PCM
+	// (8, 16, 24 and 32-bit) and IEEE float (32 and 64-bit) samples are supported,
+	// multichannel data is mixed down to mono.
+	class WavFileSource : public OfflineAudioSource
+	{
+	public:
+
+		// Layout of headerless PCM data
+		struct RawFormat
+		{
+			uint32_t	sampleRate{ 44100U };
+			uint16_t	channelCount{ 1U };
+			uint16_t	bitDepth{ 16U };
+			bool		isFloat{ false };
+		};
+
+	private:
+
+		static constexpr uint16_t s_formatPCM			{ 0x0001U };
+		static constexpr uint16_t s_formatIEEEFloat		{ 0x0003U };
+		static constexpr uint16_t s_formatExtensible	{ 0xFFFEU };
+
+		std::ifstream		file;
+		std::vector<char>	byteBuffer;
+
+		RawFormat			format;
+		std::streamoff		dataOffset;
+		uint64_t			frameCount;
+		uint64_t			framePosition;
+
+		static uint32_t ReadLittleEndian(const char* bytes, size_t byteCount) noexcept
+		{
+			uint32_t value = 0U;
+
+			for (size_t i = 0U; i < byteCount; i++)
+			{
+				value |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i])) << (8U * i);
+			}
+
+			return value;
+		}
+
+		// Convert a single sample to range [-1, 1)
+		sample_t DecodeSample(const char* bytes) const noexcept
+		{
+			if (format.isFloat)
+			{
+				if (format.bitDepth == 32U)
+				{
+					const uint32_t bits = ReadLittleEndian(bytes, 4U);
+					float value;
+					std::memcpy(&value, &bits, sizeof(value));
+					return static_cast<sample_t>(value);
+				}
+				else
+				{
+					const uint64_t bits = static_cast<uint64_t>(ReadLittleEndian(bytes, 4U)) | (static_cast<uint64_t>(ReadLittleEndian(bytes + 4, 4U)) << 32U);
+					double value;
+					std::memcpy(&value, &bits, sizeof(value));
+					return static_cast<sample_t>(value);
+				}
+			}
+
+			const size_t byteCount = format.bitDepth / 8U;
+			const uint32_t bits = ReadLittleEndian(bytes, byteCount);
+
+			// 8-bit PCM is unsigned, wider formats are two's complement
+			if (byteCount == 1U)
+			{
+				return static_cast<sample_t>(static_cast<int32_t>(bits) - 128) / static_cast<sample_t>(128);
+			}
+
+			// Sign-extend to 32 bits
+			const uint32_t shift	= 32U - 8U * static_cast<uint32_t>(byteCount);
+			const int32_t value		= static_cast<int32_t>(bits << shift) >> shift;
+
+			return static_cast<sample_t>(static_cast<double>(value) / static_cast<double>(1ULL << (8U * byteCount - 1U)));
+		}
+
+		bool IsFormatSupported() const noexcept
+		{
+			if (format.channelCount == 0U || format.sampleRate == 0U)
+			{
+				return false;
+			}
+
+			if (format.isFloat)
+			{
+				return format.bitDepth == 32U || format.bitDepth == 64U;
+			}
+
+			return format.bitDepth == 8U || format.bitDepth == 16U || format.bitDepth == 24U || format.bitDepth == 32U;
+		}
+
+		// Prepare reading frameCount frames of the current format, starting at dataOffset
+		bool PrepareData(uint64_t dataSize)
+		{
+			if (!IsFormatSupported())
+			{
+				return false;
+			}
+
+			const size_t blockAlign = static_cast<size_t>(format.channelCount) * format.bitDepth / 8U;
+
+			frameCount		= dataSize / blockAlign;
+			framePosition	= 0U;
+			byteBuffer.resize(s_hopSize * blockAlign);
+			SetSampleRate(format.sampleRate);
+
+			file.clear();
+			file.seekg(dataOffset);
+			return static_cast<bool>(file);
+		}
+
+	protected:
+
+		size_t ReadSamples(sample_t* dest, size_t count) override
+		{
+			const size_t bytesPerSample	= format.bitDepth / 8U;
+			const size_t blockAlign		= format.channelCount * bytesPerSample;
+
+			count = static_cast<size_t>(std::min<uint64_t>({ count, s_hopSize, frameCount - framePosition }));
+
+			if (count == 0U || !file.read(byteBuffer.data(), static_cast<std::streamsize>(count * blockAlign)))
+			{
+				return 0U;
+			}
+
+			const char* frameBytes = byteBuffer.data();
+
+			for (size_t n = 0U; n < count; n++, frameBytes += blockAlign)
+			{
+				sample_t sum = 0.0f;
+
+				for (size_t channel = 0U; channel < format.channelCount; channel++)
+				{
+					sum += DecodeSample(frameBytes + channel * bytesPerSample);
+				}
+
+				dest[n] = sum / static_cast<sample_t>(format.channelCount);
+			}
+
+			framePosition += count;
+			return count;
+		}
+
+		void Rewind() override
+		{
+			framePosition = 0U;
+			file.clear();
+			file.seekg(dataOffset);
+		}
+
+	public:
+
+		WavFileSource() : OfflineAudioSource{ 0U }, dataOffset{ 0 }, frameCount{ 0U }, framePosition{ 0U }
+		{
+		}
+
+		// Open a RIFF/WAVE file. Returns false if the file cannot be read or its format is not supported.
+		bool Open(const std::filesystem::path& path)
+		{
+			file = std::ifstream(path, std::ios::binary);
+
+			char header[12];
+
+			if (!file.read(header, sizeof(header)) || std::memcmp(header, "RIFF", 4U) != 0 || std::memcmp(header + 8, "WAVE", 4U) != 0)
+			{
+				return false;
+			}
+
+			bool formatFound = false;
+			char chunkHeader[8];
+
+			while (file.read(chunkHeader, sizeof(chunkHeader)))
+			{
+				const uint32_t chunkSize	= ReadLittleEndian(chunkHeader + 4, 4U);
+				// Chunks are padded to an even number of bytes
+				const std::streamoff nextChunk = static_cast<std::streamoff>(file.tellg()) + chunkSize + (chunkSize & 1U);
+
+				if (std::memcmp(chunkHeader, "fmt ", 4U) == 0)
+				{
+					char fmt[40] = {};
+
+					if (chunkSize < 16U || !file.read(fmt, std::min<std::streamsize>(chunkSize, sizeof(fmt))))
+					{
+						return false;
+					}
+
+					uint16_t formatTag = static_cast<uint16_t>(ReadLittleEndian(fmt, 2U));
+
+					// Actual format of WAVE_FORMAT_EXTENSIBLE is stored in the first two bytes of the subformat GUID
+					if (formatTag == s_formatExtensible && chunkSize >= 40U)
+					{
+						formatTag = static_cast<uint16_t>(ReadLittleEndian(fmt + 24, 2U));
+					}
+
+					format.channelCount	= static_cast<uint16_t>(ReadLittleEndian(fmt + 2, 2U));
+					format.sampleRate	= ReadLittleEndian(fmt + 4, 4U);
+					format.bitDepth		= static_cast<uint16_t>(ReadLittleEndian(fmt + 14, 2U));
+					format.isFloat		= (formatTag == s_formatIEEEFloat);
+
+					if (formatTag != s_formatPCM && formatTag != s_formatIEEEFloat)
+					{
+						return false;
+					}
+
+					formatFound = true;
+				}
+				else if (std::memcmp(chunkHeader, "data", 4U) == 0)
+				{
+					if (!formatFound)
+					{
+						return false;
+					}
+
+					dataOffset = file.tellg();
+					return PrepareData(chunkSize);
+				}
+
+				file.seekg(nextChunk);
+			}
+
+			return false;
+		}
+
+		// Open headerless PCM data of the given format
+		bool OpenRaw(const std::filesystem::path& path, const RawFormat& rawFormat)
+		{
+			file = std::ifstream(path, std::ios::binary | std::ios::ate);
+
+			if (!file)
+			{
+				return false;
+			}
+
+			format		= rawFormat;
+			dataOffset	= 0;
+			return PrepareData(static_cast<uint64_t>(file.tellg()));
+		}
+
+		// Get current bit depth
+		uint32_t GetBitDepth() const noexcept override
+		{
+			return format.bitDepth;
+		}
+
+		// Get number of channels in the file, samples are mixed down to mono
+		uint16_t GetChannelCount() const noexcept
+		{
+			return format.channelCount;
+		}
+
+		// Get length of the file in samples per channel
+		uint64_t GetFrameCount() const noexcept
+		{
+			return frameCount;
+		}
+	};
+}